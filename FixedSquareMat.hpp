@@ -0,0 +1,350 @@
+// liorbrown@outlook.co.il
+
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include "SquareMat.hpp"
+
+using namespace std;
+
+namespace Matrix{
+
+    /// @brief Call function with each index of the sequence, unrolled in compile time
+    /// @param function Function that gets the index
+    template<size_t... INDICES, class Function>
+    constexpr void unrollIndices(index_sequence<INDICES...>, Function&& function)
+    {
+        (function(INDICES), ...);
+    }
+
+    /// @brief Call function with each index from 0 to COUNT - 1, unrolled in compile time
+    /// @param function Function that gets the index
+    template<size_t COUNT, class Function>
+    constexpr void unroll(Function&& function)
+    {
+        unrollIndices(make_index_sequence<COUNT>{}, function);
+    }
+
+    /// @brief This class represents a real numbers square matrix, that its size known in compile time.
+    /// The cells are stored in the object itself, and all the loops are unrolled in compile time,
+    /// so the compiler can keep small matrices entirely in registers.
+    /// It has the same operators as SquareMat, and converts to and from it
+    template<size_t N>
+    class FixedSquareMat{
+        static_assert(N > 0, "Matrix size must be positive");
+
+        private:
+
+            /// @brief Cells of the matrix in row-major order
+            array<double, N * N> cells{};
+
+            /// @brief Get sum of all matrix numbers
+            /// @return The sum of all numbers in the matrix
+            constexpr double getSum() const
+            {
+                double result = 0;
+
+                unroll<N * N>([&](size_t cell){ result += this->cells[cell]; });
+
+                return result;
+            }
+
+        public:
+
+            /// @brief Ctor - creates zero matrix
+            constexpr FixedSquareMat() = default;
+
+            /// @brief Ctor - creates matrix with given cells
+            /// @param cells N * N cells in row-major order
+            constexpr FixedSquareMat(const array<double, N * N>& cells) : cells(cells) {}
+
+            /// @brief Ctor - creates matrix that all its cells are set to given value
+            /// @param value Value of all cells
+            constexpr FixedSquareMat(FillTag, double value)
+            {
+                this->cells.fill(value);
+            }
+
+            /// @brief Ctor - creates identity matrix
+            constexpr FixedSquareMat(IdentityTag)
+            {
+                unroll<N>([&](size_t i){ (*this)[i][i] = 1.0; });
+            }
+
+            /// @brief Ctor - creates matrix with copy of SquareMat (or block) cells
+            /// @param mat Matrix to copy, in size N
+            explicit FixedSquareMat(const ConstSquareMatView& mat)
+            {
+                if (mat.getSize() != N)
+                    throw invalid_argument("Matrices not in the same size 🫤");
+
+                unroll<N>([&](size_t i){
+                    unroll<N>([&](size_t j){ (*this)[i][j] = mat[i][j]; });
+                });
+            }
+
+            /// @brief Convert to SquareMat with copy of the cells
+            operator SquareMat() const
+            {
+                return SquareMat{N, span<const double>{this->cells}};
+            }
+
+            static constexpr size_t getSize() {return N;}
+
+            /// @brief Return matrix row, given row index
+            /// @param row Index of wanted row
+            /// @return Pointer to the wanted row
+            constexpr double* operator[](size_t row) {return this->cells.data() + row * N;}
+
+            constexpr const double* operator[](size_t row) const {return this->cells.data() + row * N;}
+
+            // ---------------- Self assignment operators ----------------------
+
+            constexpr FixedSquareMat& operator+=(const FixedSquareMat& other)
+            {
+                unroll<N * N>([&](size_t cell){ this->cells[cell] += other.cells[cell]; });
+
+                return *this;
+            }
+
+            constexpr FixedSquareMat& operator-=(const FixedSquareMat& other)
+            {
+                unroll<N * N>([&](size_t cell){ this->cells[cell] -= other.cells[cell]; });
+
+                return *this;
+            }
+
+            /// @brief Multiply this matrix by other matrix, cell by cell
+            constexpr FixedSquareMat& operator%=(const FixedSquareMat& other)
+            {
+                unroll<N * N>([&](size_t cell){ this->cells[cell] *= other.cells[cell]; });
+
+                return *this;
+            }
+
+            constexpr FixedSquareMat& operator*=(const double scalar)
+            {
+                unroll<N * N>([&](size_t cell){ this->cells[cell] *= scalar; });
+
+                return *this;
+            }
+
+            FixedSquareMat& operator/=(const double scalar)
+            {
+                if (!scalar)
+                    throw invalid_argument("Can't divide by zero 🫤");
+
+                unroll<N * N>([&](size_t cell){ this->cells[cell] /= scalar; });
+
+                return *this;
+            }
+
+            FixedSquareMat& operator%=(const int scalar)
+            {
+                if (!scalar)
+                    throw invalid_argument("Can't divide by zero 🫤");
+
+                unroll<N * N>([&](size_t cell){ this->cells[cell] = fmod(this->cells[cell], scalar); });
+
+                return *this;
+            }
+
+            /// @brief Multipy this matrix by other matrix, using standard matrix multiplication
+            constexpr FixedSquareMat& operator*=(const FixedSquareMat& other)
+            {
+                FixedSquareMat result;
+
+                // Adds each row k of other matrix, scaled by cell (i,k) of this matrix
+                unroll<N>([&](size_t i){
+                    unroll<N>([&](size_t k){
+                        const double factor = (*this)[i][k];
+
+                        unroll<N>([&](size_t j){ result[i][j] += factor * other[k][j]; });
+                    });
+                });
+
+                return *this = result;
+            }
+
+            constexpr FixedSquareMat& operator++()
+            {
+                unroll<N * N>([&](size_t cell){ this->cells[cell]++; });
+
+                return *this;
+            }
+
+            constexpr FixedSquareMat operator++(int)
+            {
+                FixedSquareMat result{*this};
+                ++*this;
+
+                return result;
+            }
+
+            constexpr FixedSquareMat& operator--()
+            {
+                unroll<N * N>([&](size_t cell){ this->cells[cell]--; });
+
+                return *this;
+            }
+
+            constexpr FixedSquareMat operator--(int)
+            {
+                FixedSquareMat result{*this};
+                --*this;
+
+                return result;
+            }
+
+            // ---------------- Equality operators ----------------------
+            // Like in SquareMat, they check only the sum of matrices, not their cells values
+
+            constexpr bool operator==(const FixedSquareMat& other) const {return this->getSum() == other.getSum();}
+
+            constexpr bool operator!=(const FixedSquareMat& other) const {return this->getSum() != other.getSum();}
+
+            constexpr bool operator<(const FixedSquareMat& other) const {return this->getSum() < other.getSum();}
+
+            constexpr bool operator<=(const FixedSquareMat& other) const {return this->getSum() <= other.getSum();}
+
+            constexpr bool operator>(const FixedSquareMat& other) const {return this->getSum() > other.getSum();}
+
+            constexpr bool operator>=(const FixedSquareMat& other) const {return this->getSum() >= other.getSum();}
+
+            // ---------------- Unary operators ----------------------
+
+            constexpr FixedSquareMat operator-() const
+            {
+                FixedSquareMat result{*this};
+
+                return result *= -1.0;
+            }
+
+            /// @brief Return the determinant of this matrix.
+            /// Sizes up to 3 use the closed formulas, bigger ones Gaussian elimination with partial pivoting
+            constexpr double operator!() const
+            {
+                const FixedSquareMat& m = *this;
+
+                if constexpr (N == 1)
+                    return m[0][0];
+                else if constexpr (N == 2)
+                    return m[0][0] * m[1][1] - m[0][1] * m[1][0];
+                else if constexpr (N == 3)
+                    return m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1])
+                         - m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0])
+                         + m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+                else
+                {
+                    FixedSquareMat work{*this};
+                    double result = 1;
+
+                    for (size_t col = 0; col < N; col++)
+                    {
+                        // Take the biggest cell in the column as pivot, so the elimination is stable
+                        size_t pivot = col;
+
+                        for (size_t i = col + 1; i < N; i++)
+                        {
+                            const double cell = work[i][col], best = work[pivot][col];
+
+                            if ((cell < 0 ? -cell : cell) > (best < 0 ? -best : best))
+                                pivot = i;
+                        }
+
+                        if (!work[pivot][col])
+                            return 0;
+
+                        // Rows swap changes the determinant sign
+                        if (pivot != col)
+                        {
+                            unroll<N>([&](size_t j){ std::swap(work[pivot][j], work[col][j]); });
+                            result = -result;
+                        }
+
+                        result *= work[col][col];
+
+                        for (size_t i = col + 1; i < N; i++)
+                        {
+                            const double factor = work[i][col] / work[col][col];
+
+                            unroll<N>([&](size_t j){ work[i][j] -= factor * work[col][j]; });
+                        }
+                    }
+
+                    return result;
+                }
+            }
+
+            /// @brief Return matrix of this matrix power given exponent, by repeated squaring
+            /// @param exp The number of time to multiply this matrix with itself
+            constexpr FixedSquareMat operator^(size_t exp) const
+            {
+                FixedSquareMat result{Identity};
+                FixedSquareMat square{*this};
+
+                while (exp)
+                {
+                    if (exp & 1)
+                        result *= square;
+
+                    square *= square;
+                    exp >>= 1;
+                }
+
+                return result;
+            }
+    };
+
+    // ---------------- Out class operators ----------------------
+    // Like in SquareMat, the left operand is a copy that returned as the result
+
+    template<size_t N>
+    constexpr FixedSquareMat<N> operator+(FixedSquareMat<N> left, const FixedSquareMat<N>& right) {return left += right;}
+
+    template<size_t N>
+    constexpr FixedSquareMat<N> operator-(FixedSquareMat<N> left, const FixedSquareMat<N>& right) {return left -= right;}
+
+    template<size_t N>
+    constexpr FixedSquareMat<N> operator*(FixedSquareMat<N> left, const FixedSquareMat<N>& right) {return left *= right;}
+
+    template<size_t N>
+    constexpr FixedSquareMat<N> operator%(FixedSquareMat<N> left, const FixedSquareMat<N>& right) {return left %= right;}
+
+    template<size_t N>
+    constexpr FixedSquareMat<N> operator*(FixedSquareMat<N> mat, const double scalar) {return mat *= scalar;}
+
+    template<size_t N>
+    constexpr FixedSquareMat<N> operator*(const double scalar, FixedSquareMat<N> mat) {return mat *= scalar;}
+
+    template<size_t N>
+    FixedSquareMat<N> operator/(FixedSquareMat<N> mat, const double scalar) {return mat /= scalar;}
+
+    template<size_t N>
+    FixedSquareMat<N> operator%(FixedSquareMat<N> mat, const int scalar) {return mat %= scalar;}
+
+    /// @brief Return matrix transpose
+    template<size_t N>
+    constexpr FixedSquareMat<N> operator~(const FixedSquareMat<N>& mat)
+    {
+        FixedSquareMat<N> result;
+
+        unroll<N>([&](size_t i){
+            unroll<N>([&](size_t j){ result[j][i] = mat[i][j]; });
+        });
+
+        return result;
+    }
+
+    /// @brief Print the matrix, like SquareMat is printed
+    template<size_t N>
+    ostream& operator<<(ostream& stream, const FixedSquareMat<N>& mat)
+    {
+        return stream << SquareMat{mat};
+    }
+}
@@ -0,0 +1,79 @@
+// liorbrown@outlook.co.il
+
+#include <stdexcept>
+#include <algorithm>
+#include <cstdint>
+#include "MatArena.hpp"
+
+namespace Matrix{
+    thread_local MatArena* MatArena::active = nullptr;
+
+    MatArena::MatArena(size_t chunkSize) : chunkSize(chunkSize), current(0), offset(0), liveBlocks(0){
+        if (!chunkSize)
+            throw invalid_argument("Arena chunk size must be positive 🫤");
+
+        this->chunks.push_back({new char[chunkSize], chunkSize});
+    }
+
+    MatArena::~MatArena()
+    {
+        for (Chunk& chunk : this->chunks)
+            delete[] chunk.memory;
+    }
+
+    void* MatArena::allocate(size_t bytes, size_t alignment)
+    {
+        // Runs on the chunks from current one, until finding one with enough space
+        while (this->current < this->chunks.size())
+        {
+            Chunk& chunk = this->chunks[this->current];
+
+            // Align the bump offset with the address itself, so any chunk address is fine
+            uintptr_t address = reinterpret_cast<uintptr_t>(chunk.memory) + this->offset;
+            size_t start = this->offset + ((alignment - address % alignment) % alignment);
+
+            if (start + bytes <= chunk.capacity)
+            {
+                this->offset = start + bytes;
+                this->liveBlocks++;
+
+                return chunk.memory + start;
+            }
+
+            // Move to next chunk
+            this->current++;
+            this->offset = 0;
+        }
+
+        // No chunk has enough space, so add new one, with extra space for the alignment
+        size_t capacity = max(this->chunkSize, bytes + alignment);
+        this->chunks.push_back({new char[capacity], capacity});
+
+        return this->allocate(bytes, alignment);
+    }
+
+    void MatArena::release(void*)
+    {
+        this->liveBlocks--;
+    }
+
+    void MatArena::reset()
+    {
+        if (this->liveBlocks)
+            throw logic_error("Can't reset arena while matrices still use it 🫤");
+
+        // All chunks are kept, and used again from the first one
+        this->current = 0;
+        this->offset = 0;
+    }
+
+    size_t MatArena::getCapacity() const
+    {
+        size_t result = 0;
+
+        for (const Chunk& chunk : this->chunks)
+            result += chunk.capacity;
+
+        return result;
+    }
+}
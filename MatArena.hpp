@@ -0,0 +1,106 @@
+// liorbrown@outlook.co.il
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+using namespace std;
+
+namespace Matrix{
+
+    /// @brief This class represents a bump arena for matrices memory.
+    /// While an arena is active on a thread (see ArenaScope), every heap matrix created
+    /// on that thread draws its memory from the arena, and all of it released in one reset.
+    /// Each thread should use its own arena, so threads not contend on the global allocator.
+    class MatArena{
+        private:
+
+            /// @brief One block of memory that allocations bumped from it
+            struct Chunk{
+                char* memory;
+                size_t capacity;
+            };
+
+            /// @brief Minimal size of each chunk
+            size_t chunkSize;
+
+            /// @brief All the chunks of the arena, they are kept for reuse after reset
+            vector<Chunk> chunks;
+
+            /// @brief Index of the chunk that allocations are bumped from it
+            size_t current;
+
+            /// @brief Offset of the first free byte in the current chunk
+            size_t offset;
+
+            /// @brief Number of allocations that not released yet
+            atomic<size_t> liveBlocks;
+
+            /// @brief The arena that is active on this thread, if any
+            static thread_local MatArena* active;
+
+            friend class ArenaScope;
+
+        public:
+
+            /// @brief Ctor - creates arena with one chunk in given size
+            /// @param chunkSize Size (in bytes) of each arena chunk,
+            /// bigger allocations get their own chunk
+            MatArena(size_t chunkSize);
+
+            /// @brief Dtor - free all arena chunks.
+            /// All matrices that use the arena must be destroyed before it
+            ~MatArena();
+
+            MatArena(const MatArena& other) = delete;
+            MatArena& operator=(const MatArena& other) = delete;
+
+            /// @brief Bump new memory block from the arena, aligned to given alignment
+            /// @param bytes Size of the wanted block
+            /// @param alignment Alignment of the block, must be power of 2
+            /// @return Pointer to the new block
+            void* allocate(size_t bytes, size_t alignment);
+
+            /// @brief Mark memory block as not used anymore.
+            /// The memory itself returns to the arena only on reset
+            /// @param memory Block that was allocated from this arena
+            void release(void* memory);
+
+            /// @brief Rewind the arena, so all its memory can be used again.
+            /// Throws logic_error if any allocated block not released yet
+            void reset();
+
+            /// @brief Get number of allocations that not released yet
+            /// @return Number of live blocks
+            size_t getLiveBlocks() const {return this->liveBlocks;}
+
+            /// @brief Get total number of bytes that arena holds in all its chunks
+            /// @return Arena capacity in bytes
+            size_t getCapacity() const;
+
+            /// @brief Get the arena that is active on the calling thread
+            /// @return Active arena, or nullptr if there is no such one
+            static MatArena* getActive() {return active;}
+    };
+
+    /// @brief This class activates an arena for the calling thread as long as it alive,
+    /// and restores the previous active arena when destroyed
+    class ArenaScope{
+        private:
+            MatArena* previous;
+
+        public:
+
+            /// @brief Ctor - activates given arena on this thread
+            /// @param arena Arena to activate
+            ArenaScope(MatArena& arena) : previous(MatArena::active) {MatArena::active = &arena;}
+
+            /// @brief Dtor - restores the arena that was active before
+            ~ArenaScope(){ MatArena::active = this->previous;}
+
+            ArenaScope(const ArenaScope& other) = delete;
+            ArenaScope& operator=(const ArenaScope& other) = delete;
+    };
+}
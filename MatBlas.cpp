@@ -0,0 +1,147 @@
+// liorbrown@outlook.co.il
+
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+#include "MatBlas.hpp"
+#include "SquareMat.hpp"
+
+#ifdef SQUAREMAT_BLAS
+
+// Fortran interface of BLAS and LAPACK, that all the libraries export,
+// so no library header is needed. All the arguments are passed by pointer
+extern "C" {
+    void dgemm_(const char* transA, const char* transB, const int* m, const int* n, const int* k,
+        const double* alpha, const double* a, const int* lda, const double* b, const int* ldb,
+        const double* beta, double* c, const int* ldc);
+
+    void dgetrf_(const int* m, const int* n, double* a, const int* lda, int* pivots, int* info);
+}
+
+#endif
+
+namespace Matrix{
+
+    /// @brief Choose the backend to start with: BLAS if the build has it,
+    /// unless SQUAREMAT_BACKEND=builtin
+    /// @return The backend
+    static Backend chooseBackend()
+    {
+        const char* pinned = getenv("SQUAREMAT_BACKEND");
+
+        if (!isBlasAvailable() || (pinned && !strcmp(pinned, "builtin")))
+            return Backend::Builtin;
+
+        return Backend::Blas;
+    }
+
+    /// @brief Get the backend in use, that chosen once on first call
+    /// @return Reference to the backend in use
+    static atomic<Backend>& selected()
+    {
+        static atomic<Backend> backend{chooseBackend()};
+
+        return backend;
+    }
+
+    bool isBlasAvailable()
+    {
+#ifdef SQUAREMAT_BLAS
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    void setBackend(Backend backend)
+    {
+        if (backend == Backend::Blas && !isBlasAvailable())
+            throw invalid_argument("This build not linked with BLAS 🫤");
+
+        selected() = backend;
+    }
+
+    Backend getBackend()
+    {
+        return selected().load(memory_order_relaxed);
+    }
+
+    const char* getBackendName()
+    {
+#ifdef SQUAREMAT_BLAS
+        if (getBackend() == Backend::Blas)
+            return SQUAREMAT_BLAS;
+#endif
+
+        return "builtin";
+    }
+
+    // Builds without BLAS not use the parameters
+    bool blasGemm([[maybe_unused]] double alpha, [[maybe_unused]] const ConstSquareMatView& a,
+        [[maybe_unused]] bool transA, [[maybe_unused]] const ConstSquareMatView& b, [[maybe_unused]] bool transB,
+        [[maybe_unused]] double beta, [[maybe_unused]] const SquareMatView& c)
+    {
+#ifdef SQUAREMAT_BLAS
+        const size_t size = a.getSize();
+
+        if (getBackend() != Backend::Blas || b.getSize() != size || c.getSize() != size ||
+            max({a.getStride(), b.getStride(), c.getStride()}) > INT_MAX)
+            return false;
+
+        const int n = (int)size;
+        const int lda = (int)a.getStride(), ldb = (int)b.getStride(), ldc = (int)c.getStride();
+
+        // BLAS matrices are column-major, so it sees each row-major block as its transpose.
+        // Calculate the transposed result c' = op(b)' * op(a)', that is c itself in row-major
+        dgemm_(transB ? "T" : "N", transA ? "T" : "N", &n, &n, &n,
+            &alpha, b[0], &ldb, a[0], &lda, &beta, c[0], &ldc);
+
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    bool blasDeterminant([[maybe_unused]] const ConstSquareMatView& view, [[maybe_unused]] double& result)
+    {
+#ifdef SQUAREMAT_BLAS
+        if (getBackend() != Backend::Blas || view.getStride() > INT_MAX)
+            return false;
+
+        // LU factorization is done in place, so work on copy. The copy is seen
+        // as the transpose, that has the same determinant
+        SquareMat work{view};
+        vector<int> pivots(view.getSize());
+        const int n = (int)view.getSize(), lda = (int)work.getStride();
+        int info = 0;
+
+        dgetrf_(&n, &n, work[0], &lda, pivots.data(), &info);
+
+        // Positive info means zero pivot, so the matrix is singular
+        if (info > 0)
+        {
+            result = 0;
+            return true;
+        }
+
+        // Determinant is the product of U diagonal, and each rows swap changes its sign
+        result = 1;
+
+        for (int i = 0; i < n; i++)
+        {
+            result *= work[i][i];
+
+            if (pivots[i] != i + 1)
+                result = -result;
+        }
+
+        return true;
+#else
+        return false;
+#endif
+    }
+}
@@ -0,0 +1,58 @@
+// liorbrown@outlook.co.il
+
+#pragma once
+
+#include <cstddef>
+#include "SquareMatView.hpp"
+
+using namespace std;
+
+namespace Matrix{
+
+    // ---------------- External BLAS backend ----------------------
+    // When built with BLAS library (like make BLAS=openblas), multiplication calls its dgemm,
+    // and determinant its dgetrf. The built-in kernels stay the default of other builds,
+    // and they are used for anything the library can't do (like sizes bigger than its int)
+
+    /// @brief Who calculates multiplication and determinant
+    enum class Backend{
+        /// @brief The built-in kernels (see MatGemm.hpp)
+        Builtin,
+
+        /// @brief The BLAS library that the build linked with
+        Blas
+    };
+
+    /// @brief Check whether this build linked with BLAS library
+    /// @return True - if Backend::Blas can be used, False - otherwise
+    bool isBlasAvailable();
+
+    /// @brief Choose the backend to use from now on, for benchmarks and tests.
+    /// Builds with BLAS start with Backend::Blas, unless SQUAREMAT_BACKEND=builtin
+    /// @param backend The new backend, Backend::Blas must be available
+    void setBackend(Backend backend);
+
+    Backend getBackend();
+
+    /// @brief Get name of the backend in use, like "builtin" or "openblas"
+    /// @return The name
+    const char* getBackendName();
+
+    /// @brief Calculate c = alpha * op(a) * op(b) + beta * c by the BLAS dgemm, if it is in use
+    /// @param alpha Scale of the product
+    /// @param a Left operand
+    /// @param transA Whether to use A transpose
+    /// @param b Right operand
+    /// @param transB Whether to use B transpose
+    /// @param beta Scale of c old value, 0 means c is not read
+    /// @param c Result, must not overlap the operands
+    /// @return True - if BLAS calculated it, False - if the built-in kernels have to
+    bool blasGemm(double alpha, const ConstSquareMatView& a, bool transA, const ConstSquareMatView& b, bool transB,
+        double beta, const SquareMatView& c);
+
+    /// @brief Calculate determinant by the BLAS (LAPACK) dgetrf, if it is in use
+    /// @param view Block to calculate its determinant, it is not changed
+    /// @param result Set to the determinant
+    /// @return True - if BLAS calculated it, False - if the built-in code has to
+    bool blasDeterminant(const ConstSquareMatView& view, double& result);
+}
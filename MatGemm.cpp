@@ -0,0 +1,365 @@
+// liorbrown@outlook.co.il
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+#include "MatGemm.hpp"
+#include "MatBlas.hpp"
+#include "MatKernels.hpp"
+#include "Parallel.hpp"
+
+namespace Matrix{
+
+    /// @brief Packing buffers of this thread, they grow once and reused by next multiplications
+    static thread_local vector<double> packedA;
+    static thread_local vector<double> packedB;
+
+    /// @brief Minimal matrix size that multiplied by more than one thread
+    static atomic<size_t> parallelThreshold{DEFAULT_PARALLEL_THRESHOLD};
+
+    /// @brief Multiply by plain i-k-j loops, both operands walked along their rows
+    /// (unless they are transposed), and write alpha * product + beta * c
+    /// @param alpha Scale of the product
+    /// @param a Left operand
+    /// @param transA Whether to use A transpose
+    /// @param b Right operand
+    /// @param transB Whether to use B transpose
+    /// @param beta Scale of the result old value, 0 means result is not read
+    /// @param c Result
+    static void multiplySmall(double alpha, const ConstSquareMatView& a, bool transA, const ConstSquareMatView& b, bool transB,
+        double beta, const SquareMatView& c)
+    {
+        const size_t size = a.getSize();
+
+        for (size_t i = 0; i < size; i++)
+        {
+            double* row = c[i];
+
+            if (beta)
+                for (size_t j = 0; j < size; j++)
+                    row[j] *= beta;
+            else
+                memset(row, 0, size * sizeof(double));
+
+            for (size_t k = 0; k < size; k++)
+            {
+                const double factor = alpha * (transA ? a[k][i] : a[i][k]);
+
+                if (transB)
+                    for (size_t j = 0; j < size; j++)
+                        row[j] += factor * b[j][k];
+                else
+                {
+                    const double* bRow = b[k];
+
+                    for (size_t j = 0; j < size; j++)
+                        row[j] += factor * bRow[j];
+                }
+            }
+        }
+    }
+
+    /// @brief Pack block of A into panels of mr rows, each panel stored column after column,
+    /// so the micro kernel reads it in one sequential walk. Missing rows are zero
+    /// @param mr Rows of each panel
+    /// @param a Left operand
+    /// @param trans Whether to pack block of A transpose
+    /// @param row First row of the block
+    /// @param col First column of the block
+    /// @param rows Number of rows in the block
+    /// @param depth Number of columns in the block
+    /// @param packed Buffer to pack into
+    static void packA(size_t mr, const ConstSquareMatView& a, bool trans, size_t row, size_t col,
+        size_t rows, size_t depth, double* packed)
+    {
+        for (size_t panel = 0; panel < rows; panel += mr)
+        {
+            const size_t panelRows = min(mr, rows - panel);
+
+            for (size_t k = 0; k < depth; k++)
+            {
+                // Transposed panel column is a row of A, so it is read along the row
+                if (trans)
+                {
+                    const double* aRow = a[col + k] + row + panel;
+
+                    for (size_t r = 0; r < panelRows; r++)
+                        packed[r] = aRow[r];
+                }
+                else
+                    for (size_t r = 0; r < panelRows; r++)
+                        packed[r] = a[row + panel + r][col + k];
+
+                for (size_t r = panelRows; r < mr; r++)
+                    packed[r] = 0;
+
+                packed += mr;
+            }
+        }
+    }
+
+    /// @brief Pack panel of B into slivers of nr columns, each sliver stored row after row,
+    /// so the micro kernel reads it in one sequential walk. Missing columns are zero
+    /// @param nr Columns of each sliver
+    /// @param b Right operand
+    /// @param trans Whether to pack panel of B transpose
+    /// @param row First row of the panel
+    /// @param col First column of the panel
+    /// @param depth Number of rows in the panel
+    /// @param cols Number of columns in the panel
+    /// @param packed Buffer to pack into
+    static void packB(size_t nr, const ConstSquareMatView& b, bool trans, size_t row, size_t col,
+        size_t depth, size_t cols, double* packed)
+    {
+        for (size_t sliver = 0; sliver < cols; sliver += nr)
+        {
+            const size_t sliverCols = min(nr, cols - sliver);
+
+            for (size_t k = 0; k < depth; k++)
+            {
+                // Transposed sliver row is a column of B
+                if (trans)
+                    for (size_t j = 0; j < sliverCols; j++)
+                        packed[j] = b[col + sliver + j][row + k];
+                else
+                {
+                    const double* bRow = b[row + k] + col + sliver;
+
+                    for (size_t j = 0; j < sliverCols; j++)
+                        packed[j] = bRow[j];
+                }
+
+                for (size_t j = sliverCols; j < nr; j++)
+                    packed[j] = 0;
+
+                packed += nr;
+            }
+        }
+    }
+
+    /// @brief Multiply rows block of A by B, into the same rows of the result.
+    /// Each cell is calculated the same way whatever rows block it is in,
+    /// so splitting the rows between threads not change the result
+    /// @param kernels Kernels to use
+    /// @param alpha Scale of the product
+    /// @param a Left operand
+    /// @param transA Whether to use A transpose
+    /// @param b Right operand
+    /// @param transB Whether to use B transpose
+    /// @param beta Scale of the result old value, 0 means result is not read
+    /// @param c Result
+    /// @param begin First row of the block
+    /// @param end One after the last row of the block
+    /// @param prepacked B panels that already packed (see PackedOperand), or nullptr to pack them here
+    static void multiplyRows(const Kernels& kernels, double alpha, const ConstSquareMatView& a, bool transA,
+        const ConstSquareMatView& b, bool transB, double beta, const SquareMatView& c, size_t begin, size_t end,
+        const double* prepacked)
+    {
+        const size_t size = a.getSize();
+        const size_t mr = kernels.mr;
+        const size_t nr = kernels.nr;
+
+        // Buffers are rounded up to whole micro panels
+        const size_t mc = min(GEMM_MC, (end - begin + mr - 1) / mr * mr);
+        const size_t nc = min(GEMM_NC, (size + nr - 1) / nr * nr);
+        const size_t kc = min(GEMM_KC, size);
+
+        if (packedA.size() < mc * kc)
+            packedA.resize(mc * kc);
+
+        if (!prepacked && packedB.size() < kc * nc)
+            packedB.resize(kc * nc);
+
+        // B panel (L3) loop, then depth loop, then A block (L2) loop,
+        // so each packed B panel is used by all A blocks
+        for (size_t jc = 0; jc < size; jc += GEMM_NC)
+        {
+            const size_t cols = min(GEMM_NC, size - jc);
+
+            for (size_t pc = 0; pc < size; pc += GEMM_KC)
+            {
+                const size_t depth = min(GEMM_KC, size - pc);
+
+                const double* panel = prepacked;
+
+                // Prepacked panels are stored one after the other, in the order of these loops
+                if (prepacked)
+                    prepacked += depth * ((cols + nr - 1) / nr * nr);
+                else
+                {
+                    packB(nr, b, transB, pc, jc, depth, cols, packedB.data());
+                    panel = packedB.data();
+                }
+
+                for (size_t ic = begin; ic < end; ic += GEMM_MC)
+                {
+                    const size_t rows = min(GEMM_MC, end - ic);
+
+                    packA(mr, a, transA, ic, pc, rows, depth, packedA.data());
+
+                    // Micro kernel on each mr x nr block of the result,
+                    // the first depth block scales the result by beta and the next ones add to it
+                    for (size_t jr = 0; jr < cols; jr += nr)
+                        for (size_t ir = 0; ir < rows; ir += mr)
+                            kernels.microKernel(depth, packedA.data() + ir * depth, panel + jr * depth,
+                                c[ic + ir] + jc + jr, c.getStride(),
+                                min(mr, rows - ir), min(nr, cols - jr), alpha, pc ? 1.0 : beta);
+                }
+            }
+        }
+    }
+
+    /// @brief Check whether 2 blocks share any cell. Blocks in the same stride may be
+    /// in the same matrix, so when their ranges meet they are compared by rows and columns
+    /// @return True - if any cell of one block is also cell of the other, False - otherwise
+    static bool overlaps(const ConstSquareMatView& x, const ConstSquareMatView& y)
+    {
+        const double* xBegin = x[0];
+        const double* yBegin = y[0];
+
+        if (x[x.getSize() - 1] + x.getSize() <= yBegin || y[y.getSize() - 1] + y.getSize() <= xBegin)
+            return false;
+
+        if (x.getStride() != y.getStride())
+            return true;
+
+        if (yBegin < xBegin)
+            return overlaps(y, x);
+
+        // Y starts rows down and columns right of x start, or one row more and columns left of it
+        const size_t stride = x.getStride();
+        const size_t rows = (yBegin - xBegin) / stride, cols = (yBegin - xBegin) % stride;
+
+        return rows < x.getSize() &&
+            (cols < x.getSize() || (rows + 1 < x.getSize() && stride - cols < y.getSize()));
+    }
+
+    /// @brief Calculate c = alpha * op(a) * op(b) + beta * c, by the small loops or the blocked kernel,
+    /// that split between threads for big matrices
+    /// @param kernels Kernels to use, all threads use the same kernels, so the result not depends on the threads
+    /// @param prepacked B panels that already packed for these kernels, or nullptr to pack them while multiplying
+    /// @param threads Number of threads, 0 means getThreadCount()
+    static void gemmThreads(const Kernels& kernels, double alpha, const ConstSquareMatView& a, bool transA,
+        const ConstSquareMatView& b, bool transB, const double* prepacked, double beta, const SquareMatView& c,
+        size_t threads)
+    {
+        const size_t size = a.getSize();
+
+        if (b.getSize() != size || c.getSize() != size)
+            throw invalid_argument("Matrices sizes not fit to by multipied 🫤");
+
+        // Result cells are written while the operands are still read
+        if (overlaps(a, c) || overlaps(b, c))
+            throw invalid_argument("Result matrix can't be one of the operands 🫤");
+
+        // Builds with BLAS library let it multiply, unless the operand is already packed for the kernels
+        if (!prepacked && blasGemm(alpha, a, transA, b, transB, beta, c))
+            return;
+
+        if (size <= GEMM_SMALL)
+        {
+            multiplySmall(alpha, a, transA, b, transB, beta, c);
+            return;
+        }
+
+        if (size < parallelThreshold)
+            threads = 1;
+        else if (!threads)
+            threads = getThreadCount();
+
+        // Each thread calculates its own rows block, so the threads never write the same cells
+        parallelRows(size, threads, [&](size_t begin, size_t end)
+        {
+            multiplyRows(kernels, alpha, a, transA, b, transB, beta, c, begin, end, prepacked);
+        });
+    }
+
+    void setParallelThreshold(size_t size)
+    {
+        parallelThreshold = size;
+    }
+
+    size_t getParallelThreshold()
+    {
+        return parallelThreshold;
+    }
+
+    void multiply(const ConstSquareMatView& a, const ConstSquareMatView& b, const SquareMatView& c, size_t threads)
+    {
+        gemmThreads(getKernels(), 1.0, a, false, b, false, nullptr, 0.0, c, threads);
+    }
+
+    void gemm(double alpha, const ConstSquareMatView& a, const ConstSquareMatView& b, double beta, const SquareMatView& c,
+        bool transA, bool transB)
+    {
+        gemmThreads(getKernels(), alpha, a, transA, b, transB, nullptr, beta, c, 0);
+    }
+
+    PackedOperand::PackedOperand(const ConstSquareMatView& b, bool trans) :
+        kernels(&getKernels()), size(b.getSize())
+    {
+        const size_t nr = this->kernels->nr;
+
+        // Small matrices are multiplied by plain loops, that read dense rows
+        if (this->size <= GEMM_SMALL)
+        {
+            this->cells.resize(this->size * this->size);
+
+            for (size_t i = 0; i < this->size; i++)
+                for (size_t j = 0; j < this->size; j++)
+                    this->cells[i * this->size + j] = trans ? b[j][i] : b[i][j];
+
+            return;
+        }
+
+        // Each panel columns are rounded up to whole slivers, like multiplyRows() reads them
+        size_t length = 0;
+
+        for (size_t jc = 0; jc < this->size; jc += GEMM_NC)
+            length += this->size * ((min(GEMM_NC, this->size - jc) + nr - 1) / nr * nr);
+
+        this->cells.resize(length);
+
+        // Pack the panels in the order of multiplyRows() loops
+        double* packed = this->cells.data();
+
+        for (size_t jc = 0; jc < this->size; jc += GEMM_NC)
+        {
+            const size_t cols = min(GEMM_NC, this->size - jc);
+
+            for (size_t pc = 0; pc < this->size; pc += GEMM_KC)
+            {
+                const size_t depth = min(GEMM_KC, this->size - pc);
+
+                packB(nr, b, trans, pc, jc, depth, cols, packed);
+                packed += depth * ((cols + nr - 1) / nr * nr);
+            }
+        }
+    }
+
+    /// @brief Calculate c = alpha * op(a) * b + beta * c, with packed right operand
+    /// @param threads Number of threads, 0 means getThreadCount()
+    static void gemmPacked(double alpha, const ConstSquareMatView& a, bool transA, const PackedOperand& b,
+        double beta, const SquareMatView& c, size_t threads)
+    {
+        // Small operand cells are dense copy, that the plain loops read as matrix.
+        // Bigger ones are read only as panels, and their cells (that are never less
+        // than size * size) are viewed just for the sizes check
+        const ConstSquareMatView cells{b.getCells(), b.getSize(), b.getSize()};
+
+        gemmThreads(b.getPackingKernels(), alpha, a, transA, cells, false, b.getCells(), beta, c, threads);
+    }
+
+    void multiply(const ConstSquareMatView& a, const PackedOperand& b, const SquareMatView& c, size_t threads)
+    {
+        gemmPacked(1.0, a, false, b, 0.0, c, threads);
+    }
+
+    void gemm(double alpha, const ConstSquareMatView& a, const PackedOperand& b, double beta, const SquareMatView& c,
+        bool transA)
+    {
+        gemmPacked(alpha, a, transA, b, beta, c, 0);
+    }
+}
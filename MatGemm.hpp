@@ -0,0 +1,111 @@
+// liorbrown@outlook.co.il
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include "SquareMatView.hpp"
+
+using namespace std;
+
+namespace Matrix{
+
+    struct Kernels;
+
+    // ---------------- Matrix multiplication kernel ----------------------
+    // Blocked multiplication in the GotoBLAS way: B is packed in KC x NC panels (for L3),
+    // A in MC x KC blocks (for L2), and a MR x NR micro kernel (see MatKernels.hpp) keeps
+    // its block of the result in registers, while it walks the packed panels in L1
+
+    /// @brief Rows of A block that packed together, so the block stays in L2.
+    /// Multiple of MR of all the micro kernels
+    constexpr size_t GEMM_MC = 96;
+
+    /// @brief Depth of A block and B panel, so micro kernel panels stay in L1
+    constexpr size_t GEMM_KC = 256;
+
+    /// @brief Columns of B panel that packed together, so the panel stays in L3
+    constexpr size_t GEMM_NC = 2048;
+
+    /// @brief Matrices up to this size are multiplied by plain loops, because packing costs more
+    constexpr size_t GEMM_SMALL = 32;
+
+    /// @brief Default minimal matrix size that multiplied by more than one thread
+    constexpr size_t DEFAULT_PARALLEL_THRESHOLD = 256;
+
+    /// @brief Set minimal matrix size that multiplied by more than one thread,
+    /// smaller matrices are multiplied by the calling thread only
+    /// @param size The new threshold
+    void setParallelThreshold(size_t size);
+
+    size_t getParallelThreshold();
+
+    /// @brief Multiply 2 square blocks into third one, that may be uninitialized.
+    /// Result must not overlap the operands, otherwise invalid_argument is thrown.
+    /// Big matrices split their rows between threads (see parallelRows()),
+    /// and the result is the same in any number of threads
+    /// @param a Left operand
+    /// @param b Right operand
+    /// @param c Result, in the same size, its cells are overridden with a * b
+    /// @param threads Number of threads, 0 means getThreadCount()
+    void multiply(const ConstSquareMatView& a, const ConstSquareMatView& b, const SquareMatView& c, size_t threads = 0);
+
+    /// @brief Calculate c = alpha * op(a) * op(b) + beta * c in one pass over c, without temporary matrices,
+    /// where op() is the block itself or its transpose. Like the multiply() above, result must not overlap
+    /// the operands, and big matrices split their rows between threads.
+    /// For example c = a * b * 2.0 + c is gemm(2.0, a, b, 1.0, c)
+    /// @param alpha Scale of the product
+    /// @param a Left operand
+    /// @param b Right operand
+    /// @param beta Scale of c old value, when it is 0 c is not read, so it may be uninitialized
+    /// @param c Result, in the same size
+    /// @param transA Whether to multiply by a transpose
+    /// @param transB Whether to multiply by b transpose
+    void gemm(double alpha, const ConstSquareMatView& a, const ConstSquareMatView& b, double beta, const SquareMatView& c,
+        bool transA = false, bool transB = false);
+
+    /// @brief This class represents right operand of multiplication, that already packed
+    /// in the panels the blocked kernel reads. Multiplying many times by the same matrix
+    /// (like in power, or iterative algorithms) packs it only once, instead of on every multiplication.
+    /// The packed cells are a copy, so later changes of the source matrix are not seen
+    /// until it is packed again
+    class PackedOperand{
+        private:
+
+            /// @brief Kernels that the panels were packed for, their NR decides the panels width
+            const Kernels* kernels;
+
+            size_t size;
+
+            /// @brief The packed panels, in the order the kernel reads them.
+            /// Small matrices are multiplied by plain loops, so they are kept as dense copy instead
+            vector<double> cells;
+
+        public:
+
+            /// @brief Ctor - pack the right operand
+            /// @param b Matrix to pack
+            /// @param trans Whether to pack b transpose
+            explicit PackedOperand(const ConstSquareMatView& b, bool trans = false);
+
+            size_t getSize() const {return this->size;}
+
+            /// @brief Get the kernels that must multiply by this operand
+            const Kernels& getPackingKernels() const {return *this->kernels;}
+
+            /// @brief Get the packed cells, in the order the kernel reads them
+            const double* getCells() const {return this->cells.data();}
+    };
+
+    /// @brief Multiply square block by packed operand into third block, like the multiply() above
+    /// @param a Left operand
+    /// @param b Packed right operand
+    /// @param c Result, in the same size, its cells are overridden with a * b
+    /// @param threads Number of threads, 0 means getThreadCount()
+    void multiply(const ConstSquareMatView& a, const PackedOperand& b, const SquareMatView& c, size_t threads = 0);
+
+    /// @brief Calculate c = alpha * op(a) * b + beta * c, like the gemm() above, with packed right operand
+    /// (that already may be packed as transpose)
+    void gemm(double alpha, const ConstSquareMatView& a, const PackedOperand& b, double beta, const SquareMatView& c,
+        bool transA = false);
+}
@@ -0,0 +1,189 @@
+// liorbrown@outlook.co.il
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include "MatKernels.hpp"
+
+namespace Matrix{
+
+    /// @brief Register block of the generic multiplication micro kernel
+    static constexpr size_t GENERIC_MR = 4;
+    static constexpr size_t GENERIC_NR = 4;
+
+    static void genericMicroKernel(size_t depth, const double* a, const double* b, double* c, size_t stride,
+        size_t rows, size_t cols, double alpha, double beta)
+    {
+        double acc[GENERIC_MR][GENERIC_NR] = {};
+
+        for (size_t k = 0; k < depth; k++)
+        {
+            for (size_t r = 0; r < GENERIC_MR; r++)
+                for (size_t j = 0; j < GENERIC_NR; j++)
+                    acc[r][j] += a[r] * b[j];
+
+            a += GENERIC_MR;
+            b += GENERIC_NR;
+        }
+
+        for (size_t r = 0; r < rows; r++)
+        {
+            double* row = c + r * stride;
+
+            for (size_t j = 0; j < cols; j++)
+                row[j] = beta ? alpha * acc[r][j] + beta * row[j] : alpha * acc[r][j];
+        }
+    }
+
+    static void genericAdd(double* row, const double* other, size_t count)
+    {
+        for (size_t j = 0; j < count; j++)
+            row[j] += other[j];
+    }
+
+    static void genericSubtract(double* row, const double* other, size_t count)
+    {
+        for (size_t j = 0; j < count; j++)
+            row[j] -= other[j];
+    }
+
+    static void genericMultiply(double* row, const double* other, size_t count)
+    {
+        for (size_t j = 0; j < count; j++)
+            row[j] *= other[j];
+    }
+
+    static void genericScale(double* row, double scalar, size_t count)
+    {
+        for (size_t j = 0; j < count; j++)
+            row[j] *= scalar;
+    }
+
+    static void genericDivide(double* row, double scalar, size_t count)
+    {
+        for (size_t j = 0; j < count; j++)
+            row[j] /= scalar;
+    }
+
+    static double genericSum(const double* row, size_t count)
+    {
+        double result = 0;
+
+        for (size_t j = 0; j < count; j++)
+            result += row[j];
+
+        return result;
+    }
+
+    static void genericMultiplyAdd(double* row, const double* left, const double* right, size_t count)
+    {
+        for (size_t j = 0; j < count; j++)
+            row[j] += left[j] * right[j];
+    }
+
+    /// @brief Plain C++ variant, for CPUs without any of the other instruction sets
+    static void genericMultiplyAddIntegers(uint64_t* row, uint64_t factor, const int64_t* other, size_t count)
+    {
+        for (size_t j = 0; j < count; j++)
+            row[j] += (uint32_t)factor * (uint64_t)(uint32_t)other[j];
+    }
+
+    static void genericAddScaled(double* row, const double* other, double scalar, size_t count)
+    {
+        for (size_t j = 0; j < count; j++)
+            row[j] += scalar * other[j];
+    }
+
+    static const Kernels GENERIC_KERNELS{"generic", KernelLevel::Generic, GENERIC_MR, GENERIC_NR,
+        genericMicroKernel, genericAdd, genericSubtract, genericMultiply, genericScale, genericDivide, genericSum, genericMultiplyAdd,
+        genericMultiplyAddIntegers, genericAddScaled};
+
+    bool isKernelSupported(KernelLevel level)
+    {
+        switch (level)
+        {
+            case KernelLevel::Generic:
+                return true;
+
+#if defined(__x86_64__)
+            // SSE2 is part of every x86-64 CPU
+            case KernelLevel::Sse2:
+                return true;
+
+            case KernelLevel::Avx2:
+                return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+
+            case KernelLevel::Avx512:
+                return __builtin_cpu_supports("avx512f");
+#endif
+
+            default:
+                return false;
+        }
+    }
+
+    /// @brief Get kernels variant of given level
+    /// @param level Instruction set of the variant, must be supported
+    /// @return The kernels
+    static const Kernels& levelKernels(KernelLevel level)
+    {
+        switch (level)
+        {
+#if defined(__x86_64__)
+            case KernelLevel::Sse2:
+                return sse2Kernels();
+
+            case KernelLevel::Avx2:
+                return avx2Kernels();
+
+            case KernelLevel::Avx512:
+                return avx512Kernels();
+#endif
+
+            default:
+                return GENERIC_KERNELS;
+        }
+    }
+
+    /// @brief Choose the variant to start with: the one in SQUAREMAT_KERNEL if it is supported,
+    /// and otherwise the best one that supported
+    /// @return The kernels
+    static const Kernels* chooseKernels()
+    {
+        const KernelLevel levels[] = {KernelLevel::Avx512, KernelLevel::Avx2, KernelLevel::Sse2, KernelLevel::Generic};
+
+        if (const char* pinned = getenv("SQUAREMAT_KERNEL"))
+            for (KernelLevel level : levels)
+                if (isKernelSupported(level) && !strcmp(pinned, levelKernels(level).name))
+                    return &levelKernels(level);
+
+        for (KernelLevel level : levels)
+            if (isKernelSupported(level))
+                return &levelKernels(level);
+
+        return &GENERIC_KERNELS;
+    }
+
+    /// @brief Get the variant in use, that chosen once on first call
+    /// @return Reference to pointer to the kernels in use
+    static atomic<const Kernels*>& selected()
+    {
+        static atomic<const Kernels*> kernels{chooseKernels()};
+
+        return kernels;
+    }
+
+    const Kernels& getKernels()
+    {
+        return *selected().load(memory_order_relaxed);
+    }
+
+    void setKernelLevel(KernelLevel level)
+    {
+        if (!isKernelSupported(level))
+            throw invalid_argument("CPU not support this kernels 🫤");
+
+        selected() = &levelKernels(level);
+    }
+}
@@ -0,0 +1,95 @@
+// liorbrown@outlook.co.il
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+using namespace std;
+
+namespace Matrix{
+
+    // ---------------- Vectorized kernels ----------------------
+    // The inner loops of the matrix operations, in variant for each instruction set.
+    // The best variant that the CPU supports is chosen once, on first use,
+    // and SQUAREMAT_KERNEL environment variable (generic, sse2, avx2 or avx512) can pin other one
+
+    /// @brief Instruction set of kernels variant
+    enum class KernelLevel{Generic, Sse2, Avx2, Avx512};
+
+    /// @brief One variant of all the kernels
+    struct Kernels{
+        /// @brief Name of the variant, as used by SQUAREMAT_KERNEL
+        const char* name;
+
+        KernelLevel level;
+
+        /// @brief Rows of the result block that the multiplication micro kernel keeps in registers
+        size_t mr;
+
+        /// @brief Columns of the result block that the multiplication micro kernel keeps in registers
+        size_t nr;
+
+        /// @brief Multiply packed A panel (mr rows, column after column) by packed B sliver
+        /// (nr columns, row after row), and write alpha * product + beta * c into the result block.
+        /// When beta is 0 the result block is not read, so it may be uninitialized
+        /// @param depth Depth of the panels
+        /// @param a Packed A panel
+        /// @param b Packed B sliver
+        /// @param c First cell of the result block
+        /// @param stride Row stride of the result
+        /// @param rows Valid rows of the result block (up to mr)
+        /// @param cols Valid columns of the result block (up to nr)
+        /// @param alpha Scale of the product
+        /// @param beta Scale of the result block old value
+        void (*microKernel)(size_t depth, const double* a, const double* b, double* c, size_t stride,
+            size_t rows, size_t cols, double alpha, double beta);
+
+        /// @brief row[j] += other[j] for count cells
+        void (*add)(double* row, const double* other, size_t count);
+
+        /// @brief row[j] -= other[j] for count cells
+        void (*subtract)(double* row, const double* other, size_t count);
+
+        /// @brief row[j] *= other[j] for count cells
+        void (*multiply)(double* row, const double* other, size_t count);
+
+        /// @brief row[j] *= scalar for count cells
+        void (*scale)(double* row, double scalar, size_t count);
+
+        /// @brief row[j] /= scalar for count cells
+        void (*divide)(double* row, double scalar, size_t count);
+
+        /// @brief Sum of count cells
+        double (*sum)(const double* row, size_t count);
+
+        /// @brief row[j] += left[j] * right[j] for count cells
+        void (*multiplyAdd)(double* row, const double* left, const double* right, size_t count);
+
+        /// @brief row[j] += factor * other[j] for count cells, in 64 bits integers.
+        /// Only the low 32 bits of factor and other cells are multiplied, they must be less than 2^32
+        void (*multiplyAddIntegers)(uint64_t* row, uint64_t factor, const int64_t* other, size_t count);
+
+        /// @brief row[j] += scalar * other[j] for count cells
+        void (*addScaled)(double* row, const double* other, double scalar, size_t count);
+    };
+
+    /// @brief Get the kernels variant that is in use
+    /// @return The kernels
+    const Kernels& getKernels();
+
+    /// @brief Check whether the CPU (and the build) supports kernels variant
+    /// @param level Instruction set of the variant
+    /// @return True - if the variant can run, False - otherwise
+    bool isKernelSupported(KernelLevel level);
+
+    /// @brief Choose kernels variant to use from now on, for benchmarks and tests
+    /// @param level Instruction set of the variant, must be supported
+    void setKernelLevel(KernelLevel level);
+
+    // Each variant in its own file, that compiled for its instruction set.
+    // Call them only if the variant is supported
+    const Kernels& sse2Kernels();
+    const Kernels& avx2Kernels();
+    const Kernels& avx512Kernels();
+}
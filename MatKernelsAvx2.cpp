@@ -0,0 +1,210 @@
+// liorbrown@outlook.co.il
+
+#include "MatKernels.hpp"
+
+#if defined(__x86_64__)
+
+#include <cmath>
+#include <immintrin.h>
+
+// Only the kernels below are compiled for AVX2, after all the includes,
+// so no shared inline function gets AVX2 code that other variants would call
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+
+namespace Matrix{
+
+    /// @brief Register block of the micro kernel, 6 rows of 2 vectors use 12 of the 16 registers
+    static constexpr size_t AVX2_MR = 6;
+    static constexpr size_t AVX2_NR = 8;
+
+    static void avx2MicroKernel(size_t depth, const double* a, const double* b, double* c, size_t stride,
+        size_t rows, size_t cols, double alpha, double beta)
+    {
+        __m256d acc[AVX2_MR][2];
+
+        for (size_t r = 0; r < AVX2_MR; r++)
+            acc[r][0] = acc[r][1] = _mm256_setzero_pd();
+
+        for (size_t k = 0; k < depth; k++)
+        {
+            const __m256d b0 = _mm256_loadu_pd(b);
+            const __m256d b1 = _mm256_loadu_pd(b + 4);
+
+            #pragma GCC unroll 6
+            for (size_t r = 0; r < AVX2_MR; r++)
+            {
+                const __m256d factor = _mm256_broadcast_sd(a + r);
+
+                acc[r][0] = _mm256_fmadd_pd(factor, b0, acc[r][0]);
+                acc[r][1] = _mm256_fmadd_pd(factor, b1, acc[r][1]);
+            }
+
+            a += AVX2_MR;
+            b += AVX2_NR;
+        }
+
+        // Edge block is written through temporary block, cell by cell
+        double edge[AVX2_MR][AVX2_NR];
+        const bool full = (rows == AVX2_MR && cols == AVX2_NR);
+        const __m256d alphas = _mm256_set1_pd(alpha);
+        const __m256d betas = _mm256_set1_pd(beta);
+
+        for (size_t r = 0; r < AVX2_MR; r++)
+            for (size_t v = 0; v < 2; v++)
+            {
+                double* cells = full ? c + r * stride + 4 * v : edge[r] + 4 * v;
+                __m256d result = _mm256_mul_pd(alphas, acc[r][v]);
+
+                if (full && beta)
+                    result = _mm256_fmadd_pd(betas, _mm256_loadu_pd(cells), result);
+
+                _mm256_storeu_pd(cells, result);
+            }
+
+        // Fused like the full block, so a cell is the same whether it falls on edge block or not
+        if (!full)
+            for (size_t r = 0; r < rows; r++)
+                for (size_t j = 0; j < cols; j++)
+                    c[r * stride + j] = beta ? fma(beta, c[r * stride + j], edge[r][j]) : edge[r][j];
+    }
+
+    static void avx2Add(double* row, const double* other, size_t count)
+    {
+        size_t j = 0;
+
+        for (; j + 4 <= count; j += 4)
+            _mm256_storeu_pd(row + j, _mm256_add_pd(_mm256_loadu_pd(row + j), _mm256_loadu_pd(other + j)));
+
+        for (; j < count; j++)
+            row[j] += other[j];
+    }
+
+    static void avx2Subtract(double* row, const double* other, size_t count)
+    {
+        size_t j = 0;
+
+        for (; j + 4 <= count; j += 4)
+            _mm256_storeu_pd(row + j, _mm256_sub_pd(_mm256_loadu_pd(row + j), _mm256_loadu_pd(other + j)));
+
+        for (; j < count; j++)
+            row[j] -= other[j];
+    }
+
+    static void avx2Multiply(double* row, const double* other, size_t count)
+    {
+        size_t j = 0;
+
+        for (; j + 4 <= count; j += 4)
+            _mm256_storeu_pd(row + j, _mm256_mul_pd(_mm256_loadu_pd(row + j), _mm256_loadu_pd(other + j)));
+
+        for (; j < count; j++)
+            row[j] *= other[j];
+    }
+
+    static void avx2Scale(double* row, double scalar, size_t count)
+    {
+        const __m256d scalars = _mm256_set1_pd(scalar);
+        size_t j = 0;
+
+        for (; j + 4 <= count; j += 4)
+            _mm256_storeu_pd(row + j, _mm256_mul_pd(_mm256_loadu_pd(row + j), scalars));
+
+        for (; j < count; j++)
+            row[j] *= scalar;
+    }
+
+    static void avx2Divide(double* row, double scalar, size_t count)
+    {
+        const __m256d scalars = _mm256_set1_pd(scalar);
+        size_t j = 0;
+
+        for (; j + 4 <= count; j += 4)
+            _mm256_storeu_pd(row + j, _mm256_div_pd(_mm256_loadu_pd(row + j), scalars));
+
+        for (; j < count; j++)
+            row[j] /= scalar;
+    }
+
+    static double avx2Sum(const double* row, size_t count)
+    {
+        // 2 accumulators, so additions not wait one for the other
+        __m256d sum0 = _mm256_setzero_pd();
+        __m256d sum1 = _mm256_setzero_pd();
+        size_t j = 0;
+
+        for (; j + 8 <= count; j += 8)
+        {
+            sum0 = _mm256_add_pd(sum0, _mm256_loadu_pd(row + j));
+            sum1 = _mm256_add_pd(sum1, _mm256_loadu_pd(row + j + 4));
+        }
+
+        double lanes[4];
+        _mm256_storeu_pd(lanes, _mm256_add_pd(sum0, sum1));
+
+        double result = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+
+        for (; j < count; j++)
+            result += row[j];
+
+        return result;
+    }
+
+    static void avx2MultiplyAdd(double* row, const double* left, const double* right, size_t count)
+    {
+        size_t j = 0;
+
+        for (; j + 4 <= count; j += 4)
+            _mm256_storeu_pd(row + j, _mm256_fmadd_pd(_mm256_loadu_pd(left + j), _mm256_loadu_pd(right + j),
+                _mm256_loadu_pd(row + j)));
+
+        for (; j < count; j++)
+            row[j] += left[j] * right[j];
+    }
+
+    static void avx2MultiplyAddIntegers(uint64_t* row, uint64_t factor, const int64_t* other, size_t count)
+    {
+        // Multiplies the low 32 bits of each 64 bits lane into full 64 bits product
+        const __m256i factors = _mm256_set1_epi64x((long long)factor);
+        size_t j = 0;
+
+        for (; j + 4 <= count; j += 4)
+        {
+            __m256i* target = (__m256i*)(row + j);
+
+            _mm256_storeu_si256(target, _mm256_add_epi64(_mm256_loadu_si256(target),
+                _mm256_mul_epu32(factors, _mm256_loadu_si256((const __m256i*)(other + j)))));
+        }
+
+        for (; j < count; j++)
+            row[j] += (uint32_t)factor * (uint64_t)(uint32_t)other[j];
+    }
+
+    static void avx2AddScaled(double* row, const double* other, double scalar, size_t count)
+    {
+        const __m256d scalars = _mm256_set1_pd(scalar);
+        size_t j = 0;
+
+        for (; j + 4 <= count; j += 4)
+            _mm256_storeu_pd(row + j, _mm256_fmadd_pd(_mm256_loadu_pd(other + j), scalars, _mm256_loadu_pd(row + j)));
+
+        for (; j < count; j++)
+            row[j] += scalar * other[j];
+    }
+}
+
+#pragma GCC pop_options
+
+namespace Matrix{
+
+    const Kernels& avx2Kernels()
+    {
+        static const Kernels kernels{"avx2", KernelLevel::Avx2, AVX2_MR, AVX2_NR,
+            avx2MicroKernel, avx2Add, avx2Subtract, avx2Multiply, avx2Scale, avx2Divide, avx2Sum, avx2MultiplyAdd,
+            avx2MultiplyAddIntegers, avx2AddScaled};
+
+        return kernels;
+    }
+}
+
+#endif
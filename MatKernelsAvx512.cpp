@@ -0,0 +1,204 @@
+// liorbrown@outlook.co.il
+
+#include "MatKernels.hpp"
+
+#if defined(__x86_64__)
+
+#include <immintrin.h>
+
+// Only the kernels below are compiled for AVX-512, after all the includes,
+// so no shared inline function gets AVX-512 code that other variants would call
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+
+namespace Matrix{
+
+    /// @brief Register block of the micro kernel, 8 rows of 2 vectors use 16 of the 32 registers
+    static constexpr size_t AVX512_MR = 8;
+    static constexpr size_t AVX512_NR = 16;
+
+    /// @brief Get mask of the first cells of a vector
+    /// @param count Number of cells (up to 8)
+    /// @return The mask
+    static __mmask8 tailMask(size_t count)
+    {
+        return (__mmask8)((1u << count) - 1);
+    }
+
+    static void avx512MicroKernel(size_t depth, const double* a, const double* b, double* c, size_t stride,
+        size_t rows, size_t cols, double alpha, double beta)
+    {
+        __m512d acc[AVX512_MR][2];
+
+        for (size_t r = 0; r < AVX512_MR; r++)
+            acc[r][0] = acc[r][1] = _mm512_setzero_pd();
+
+        for (size_t k = 0; k < depth; k++)
+        {
+            const __m512d b0 = _mm512_loadu_pd(b);
+            const __m512d b1 = _mm512_loadu_pd(b + 8);
+
+            #pragma GCC unroll 8
+            for (size_t r = 0; r < AVX512_MR; r++)
+            {
+                const __m512d factor = _mm512_set1_pd(a[r]);
+
+                acc[r][0] = _mm512_fmadd_pd(factor, b0, acc[r][0]);
+                acc[r][1] = _mm512_fmadd_pd(factor, b1, acc[r][1]);
+            }
+
+            a += AVX512_MR;
+            b += AVX512_NR;
+        }
+
+        // Edge columns are written with masks, and missing rows are skipped
+        const __m512d alphas = _mm512_set1_pd(alpha);
+        const __m512d betas = _mm512_set1_pd(beta);
+        const __mmask8 masks[2] = {tailMask(cols < 8 ? cols : 8), tailMask(cols > 8 ? cols - 8 : 0)};
+
+        for (size_t r = 0; r < rows; r++)
+            for (size_t v = 0; v < 2; v++)
+            {
+                double* cells = c + r * stride + 8 * v;
+                __m512d result = _mm512_mul_pd(alphas, acc[r][v]);
+
+                if (beta)
+                    result = _mm512_fmadd_pd(betas, _mm512_maskz_loadu_pd(masks[v], cells), result);
+
+                _mm512_mask_storeu_pd(cells, masks[v], result);
+            }
+    }
+
+    static void avx512Add(double* row, const double* other, size_t count)
+    {
+        for (size_t j = 0; j < count; j += 8)
+        {
+            const __mmask8 mask = tailMask(count - j < 8 ? count - j : 8);
+
+            _mm512_mask_storeu_pd(row + j, mask, _mm512_add_pd(_mm512_maskz_loadu_pd(mask, row + j),
+                _mm512_maskz_loadu_pd(mask, other + j)));
+        }
+    }
+
+    static void avx512Subtract(double* row, const double* other, size_t count)
+    {
+        for (size_t j = 0; j < count; j += 8)
+        {
+            const __mmask8 mask = tailMask(count - j < 8 ? count - j : 8);
+
+            _mm512_mask_storeu_pd(row + j, mask, _mm512_sub_pd(_mm512_maskz_loadu_pd(mask, row + j),
+                _mm512_maskz_loadu_pd(mask, other + j)));
+        }
+    }
+
+    static void avx512Multiply(double* row, const double* other, size_t count)
+    {
+        for (size_t j = 0; j < count; j += 8)
+        {
+            const __mmask8 mask = tailMask(count - j < 8 ? count - j : 8);
+
+            _mm512_mask_storeu_pd(row + j, mask, _mm512_mul_pd(_mm512_maskz_loadu_pd(mask, row + j),
+                _mm512_maskz_loadu_pd(mask, other + j)));
+        }
+    }
+
+    static void avx512Scale(double* row, double scalar, size_t count)
+    {
+        const __m512d scalars = _mm512_set1_pd(scalar);
+
+        for (size_t j = 0; j < count; j += 8)
+        {
+            const __mmask8 mask = tailMask(count - j < 8 ? count - j : 8);
+
+            _mm512_mask_storeu_pd(row + j, mask, _mm512_mul_pd(_mm512_maskz_loadu_pd(mask, row + j), scalars));
+        }
+    }
+
+    static void avx512Divide(double* row, double scalar, size_t count)
+    {
+        const __m512d scalars = _mm512_set1_pd(scalar);
+
+        for (size_t j = 0; j < count; j += 8)
+        {
+            const __mmask8 mask = tailMask(count - j < 8 ? count - j : 8);
+
+            // Masked cells are divided as zero, and never stored
+            _mm512_mask_storeu_pd(row + j, mask, _mm512_div_pd(_mm512_maskz_loadu_pd(mask, row + j), scalars));
+        }
+    }
+
+    static double avx512Sum(const double* row, size_t count)
+    {
+        // 2 accumulators, so additions not wait one for the other
+        __m512d sum0 = _mm512_setzero_pd();
+        __m512d sum1 = _mm512_setzero_pd();
+        size_t j = 0;
+
+        for (; j + 16 <= count; j += 16)
+        {
+            sum0 = _mm512_add_pd(sum0, _mm512_loadu_pd(row + j));
+            sum1 = _mm512_add_pd(sum1, _mm512_loadu_pd(row + j + 8));
+        }
+
+        for (; j < count; j += 8)
+            sum0 = _mm512_add_pd(sum0, _mm512_maskz_loadu_pd(tailMask(count - j < 8 ? count - j : 8), row + j));
+
+        const double result = _mm512_reduce_add_pd(_mm512_add_pd(sum0, sum1));
+
+        return result;
+    }
+
+    static void avx512MultiplyAdd(double* row, const double* left, const double* right, size_t count)
+    {
+        for (size_t j = 0; j < count; j += 8)
+        {
+            const __mmask8 mask = tailMask(count - j < 8 ? count - j : 8);
+
+            _mm512_mask_storeu_pd(row + j, mask, _mm512_fmadd_pd(_mm512_maskz_loadu_pd(mask, left + j),
+                _mm512_maskz_loadu_pd(mask, right + j), _mm512_maskz_loadu_pd(mask, row + j)));
+        }
+    }
+
+    static void avx512MultiplyAddIntegers(uint64_t* row, uint64_t factor, const int64_t* other, size_t count)
+    {
+        // Multiplies the low 32 bits of each 64 bits lane into full 64 bits product
+        const __m512i factors = _mm512_set1_epi64((long long)factor);
+
+        for (size_t j = 0; j < count; j += 8)
+        {
+            const __mmask8 mask = tailMask(count - j < 8 ? count - j : 8);
+
+            _mm512_mask_storeu_epi64(row + j, mask, _mm512_add_epi64(_mm512_maskz_loadu_epi64(mask, row + j),
+                _mm512_mul_epu32(factors, _mm512_maskz_loadu_epi64(mask, other + j))));
+        }
+    }
+
+    static void avx512AddScaled(double* row, const double* other, double scalar, size_t count)
+    {
+        const __m512d scalars = _mm512_set1_pd(scalar);
+
+        for (size_t j = 0; j < count; j += 8)
+        {
+            const __mmask8 mask = tailMask(count - j < 8 ? count - j : 8);
+
+            _mm512_mask_storeu_pd(row + j, mask, _mm512_fmadd_pd(_mm512_maskz_loadu_pd(mask, other + j), scalars,
+                _mm512_maskz_loadu_pd(mask, row + j)));
+        }
+    }
+}
+
+#pragma GCC pop_options
+
+namespace Matrix{
+
+    const Kernels& avx512Kernels()
+    {
+        static const Kernels kernels{"avx512", KernelLevel::Avx512, AVX512_MR, AVX512_NR,
+            avx512MicroKernel, avx512Add, avx512Subtract, avx512Multiply, avx512Scale, avx512Divide, avx512Sum, avx512MultiplyAdd,
+            avx512MultiplyAddIntegers, avx512AddScaled};
+
+        return kernels;
+    }
+}
+
+#endif
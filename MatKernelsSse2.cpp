@@ -0,0 +1,198 @@
+// liorbrown@outlook.co.il
+
+#include "MatKernels.hpp"
+
+#if defined(__x86_64__)
+
+#include <emmintrin.h>
+
+namespace Matrix{
+
+    /// @brief Register block of the micro kernel, 4 rows of 2 vectors use 8 of the 16 registers
+    static constexpr size_t SSE2_MR = 4;
+    static constexpr size_t SSE2_NR = 4;
+
+    static void sse2MicroKernel(size_t depth, const double* a, const double* b, double* c, size_t stride,
+        size_t rows, size_t cols, double alpha, double beta)
+    {
+        __m128d acc[SSE2_MR][2];
+
+        for (size_t r = 0; r < SSE2_MR; r++)
+            acc[r][0] = acc[r][1] = _mm_setzero_pd();
+
+        for (size_t k = 0; k < depth; k++)
+        {
+            const __m128d b0 = _mm_loadu_pd(b);
+            const __m128d b1 = _mm_loadu_pd(b + 2);
+
+            #pragma GCC unroll 4
+            for (size_t r = 0; r < SSE2_MR; r++)
+            {
+                const __m128d factor = _mm_set1_pd(a[r]);
+
+                acc[r][0] = _mm_add_pd(acc[r][0], _mm_mul_pd(factor, b0));
+                acc[r][1] = _mm_add_pd(acc[r][1], _mm_mul_pd(factor, b1));
+            }
+
+            a += SSE2_MR;
+            b += SSE2_NR;
+        }
+
+        // Edge block is written through temporary block, cell by cell
+        double edge[SSE2_MR][SSE2_NR];
+        const bool full = (rows == SSE2_MR && cols == SSE2_NR);
+        const __m128d alphas = _mm_set1_pd(alpha);
+        const __m128d betas = _mm_set1_pd(beta);
+
+        for (size_t r = 0; r < SSE2_MR; r++)
+            for (size_t v = 0; v < 2; v++)
+            {
+                double* cells = full ? c + r * stride + 2 * v : edge[r] + 2 * v;
+                __m128d result = _mm_mul_pd(alphas, acc[r][v]);
+
+                if (full && beta)
+                    result = _mm_add_pd(result, _mm_mul_pd(betas, _mm_loadu_pd(cells)));
+
+                _mm_storeu_pd(cells, result);
+            }
+
+        if (!full)
+            for (size_t r = 0; r < rows; r++)
+                for (size_t j = 0; j < cols; j++)
+                    c[r * stride + j] = beta ? edge[r][j] + beta * c[r * stride + j] : edge[r][j];
+    }
+
+    static void sse2Add(double* row, const double* other, size_t count)
+    {
+        size_t j = 0;
+
+        for (; j + 2 <= count; j += 2)
+            _mm_storeu_pd(row + j, _mm_add_pd(_mm_loadu_pd(row + j), _mm_loadu_pd(other + j)));
+
+        for (; j < count; j++)
+            row[j] += other[j];
+    }
+
+    static void sse2Subtract(double* row, const double* other, size_t count)
+    {
+        size_t j = 0;
+
+        for (; j + 2 <= count; j += 2)
+            _mm_storeu_pd(row + j, _mm_sub_pd(_mm_loadu_pd(row + j), _mm_loadu_pd(other + j)));
+
+        for (; j < count; j++)
+            row[j] -= other[j];
+    }
+
+    static void sse2Multiply(double* row, const double* other, size_t count)
+    {
+        size_t j = 0;
+
+        for (; j + 2 <= count; j += 2)
+            _mm_storeu_pd(row + j, _mm_mul_pd(_mm_loadu_pd(row + j), _mm_loadu_pd(other + j)));
+
+        for (; j < count; j++)
+            row[j] *= other[j];
+    }
+
+    static void sse2Scale(double* row, double scalar, size_t count)
+    {
+        const __m128d scalars = _mm_set1_pd(scalar);
+        size_t j = 0;
+
+        for (; j + 2 <= count; j += 2)
+            _mm_storeu_pd(row + j, _mm_mul_pd(_mm_loadu_pd(row + j), scalars));
+
+        for (; j < count; j++)
+            row[j] *= scalar;
+    }
+
+    static void sse2Divide(double* row, double scalar, size_t count)
+    {
+        const __m128d scalars = _mm_set1_pd(scalar);
+        size_t j = 0;
+
+        for (; j + 2 <= count; j += 2)
+            _mm_storeu_pd(row + j, _mm_div_pd(_mm_loadu_pd(row + j), scalars));
+
+        for (; j < count; j++)
+            row[j] /= scalar;
+    }
+
+    static double sse2Sum(const double* row, size_t count)
+    {
+        // 2 accumulators, so additions not wait one for the other
+        __m128d sum0 = _mm_setzero_pd();
+        __m128d sum1 = _mm_setzero_pd();
+        size_t j = 0;
+
+        for (; j + 4 <= count; j += 4)
+        {
+            sum0 = _mm_add_pd(sum0, _mm_loadu_pd(row + j));
+            sum1 = _mm_add_pd(sum1, _mm_loadu_pd(row + j + 2));
+        }
+
+        double lanes[2];
+        _mm_storeu_pd(lanes, _mm_add_pd(sum0, sum1));
+
+        double result = lanes[0] + lanes[1];
+
+        for (; j < count; j++)
+            result += row[j];
+
+        return result;
+    }
+
+    static void sse2MultiplyAdd(double* row, const double* left, const double* right, size_t count)
+    {
+        size_t j = 0;
+
+        for (; j + 2 <= count; j += 2)
+            _mm_storeu_pd(row + j, _mm_add_pd(_mm_loadu_pd(row + j),
+                _mm_mul_pd(_mm_loadu_pd(left + j), _mm_loadu_pd(right + j))));
+
+        for (; j < count; j++)
+            row[j] += left[j] * right[j];
+    }
+
+    static void sse2MultiplyAddIntegers(uint64_t* row, uint64_t factor, const int64_t* other, size_t count)
+    {
+        // Multiplies the low 32 bits of each 64 bits lane into full 64 bits product
+        const __m128i factors = _mm_set1_epi64x((long long)factor);
+        size_t j = 0;
+
+        for (; j + 2 <= count; j += 2)
+        {
+            __m128i* target = (__m128i*)(row + j);
+
+            _mm_storeu_si128(target, _mm_add_epi64(_mm_loadu_si128(target),
+                _mm_mul_epu32(factors, _mm_loadu_si128((const __m128i*)(other + j)))));
+        }
+
+        for (; j < count; j++)
+            row[j] += (uint32_t)factor * (uint64_t)(uint32_t)other[j];
+    }
+
+    static void sse2AddScaled(double* row, const double* other, double scalar, size_t count)
+    {
+        const __m128d scalars = _mm_set1_pd(scalar);
+        size_t j = 0;
+
+        for (; j + 2 <= count; j += 2)
+            _mm_storeu_pd(row + j, _mm_add_pd(_mm_loadu_pd(row + j), _mm_mul_pd(_mm_loadu_pd(other + j), scalars)));
+
+        for (; j < count; j++)
+            row[j] += scalar * other[j];
+    }
+
+    const Kernels& sse2Kernels()
+    {
+        static const Kernels kernels{"sse2", KernelLevel::Sse2, SSE2_MR, SSE2_NR,
+            sse2MicroKernel, sse2Add, sse2Subtract, sse2Multiply, sse2Scale, sse2Divide, sse2Sum, sse2MultiplyAdd,
+            sse2MultiplyAddIntegers, sse2AddScaled};
+
+        return kernels;
+    }
+}
+
+#endif
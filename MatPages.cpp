@@ -0,0 +1,208 @@
+// liorbrown@outlook.co.il
+
+#include <cstdint>
+#include <new>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <algorithm>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "MatPages.hpp"
+#include "SquareMat.hpp"
+
+namespace Matrix{
+
+    /// @brief Memory policy mode of mbind, that spreads pages over the nodes (MPOL_INTERLEAVE)
+    static constexpr int INTERLEAVE_POLICY = 3;
+
+    /// @brief Maximal number of pages that asked from the kernel in one call
+    static constexpr size_t PAGES_BATCH = 4096;
+
+    size_t hugePagesLength(size_t bytes)
+    {
+        return (bytes + SquareMat::HUGE_PAGE - 1) / SquareMat::HUGE_PAGE * SquareMat::HUGE_PAGE;
+    }
+
+    size_t freeReservedBytes()
+    {
+        ifstream meminfo{"/proc/meminfo"};
+        string line;
+        size_t freePages = 0, pageKiloBytes = 0;
+
+        // Lines are like "HugePages_Free:       4" and "Hugepagesize:       2048 kB"
+        while (getline(meminfo, line))
+        {
+            istringstream field{line.substr(line.find(':') + 1)};
+
+            if (line.rfind("HugePages_Free:", 0) == 0)
+                field >> freePages;
+            else if (line.rfind("Hugepagesize:", 0) == 0)
+                field >> pageKiloBytes;
+        }
+
+        return freePages * pageKiloBytes * 1024;
+    }
+
+    bool transparentHugePagesEnabled()
+    {
+        // The file holds the modes with the chosen one in brackets, like "always [madvise] never"
+        ifstream enabled{"/sys/kernel/mm/transparent_hugepage/enabled"};
+        string modes;
+
+        return getline(enabled, modes) && modes.find("[never]") == string::npos;
+    }
+
+    void* mapHugePages(size_t bytes, bool& hugeTlb)
+    {
+        const size_t length = hugePagesLength(bytes);
+
+        // Reserved pages are sure to be huge, so take them first when there are enough free ones.
+        // The count may change until the mapping, so it still may fail
+        if (freeReservedBytes() >= length)
+        {
+            void* reserved = mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+
+            if (reserved != MAP_FAILED)
+            {
+                hugeTlb = true;
+
+                return reserved;
+            }
+        }
+
+        // Map one extra huge page, so the memory can start on huge page boundary
+        char* memory = static_cast<char*>(mmap(nullptr, length + SquareMat::HUGE_PAGE,
+            PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+
+        if (memory == MAP_FAILED)
+            throw bad_alloc();
+
+        char* aligned = reinterpret_cast<char*>(hugePagesLength(reinterpret_cast<uintptr_t>(memory)));
+
+        // Unmap the unused edges before and after the aligned memory
+        if (aligned > memory)
+            munmap(memory, aligned - memory);
+
+        munmap(aligned + length, memory + SquareMat::HUGE_PAGE - aligned);
+
+        hugeTlb = false;
+
+        // Mark for transparent huge pages if the kernel gives them, otherwise it stays in regular pages
+        if (transparentHugePagesEnabled())
+            madvise(aligned, length, MADV_HUGEPAGE);
+
+        return aligned;
+    }
+
+    size_t transparentHugeBytes(const void* address)
+    {
+        ifstream smaps{"/proc/self/smaps"};
+        string line;
+        bool inMapping = false;
+        const uintptr_t target = reinterpret_cast<uintptr_t>(address);
+
+        while (getline(smaps, line))
+        {
+            uintptr_t start, end;
+            char dash;
+            istringstream header{line};
+
+            // Mapping header line starts with its address range, like "7f00-7f80 rw-p ..."
+            if (header >> hex >> start >> dash >> end && dash == '-')
+                inMapping = (start <= target && target < end);
+            else if (inMapping && line.rfind("AnonHugePages:", 0) == 0)
+            {
+                istringstream field{line.substr(line.find(':') + 1)};
+                size_t kiloBytes = 0;
+                field >> kiloBytes;
+
+                return kiloBytes * 1024;
+            }
+        }
+
+        return 0;
+    }
+
+    void* mapPages(size_t bytes)
+    {
+        void* memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+        if (memory == MAP_FAILED)
+            throw bad_alloc();
+
+        return memory;
+    }
+
+    size_t numaNodeCount()
+    {
+        // The file holds nodes range, like "0" or "0-3", so the last number is the last node
+        ifstream possible{"/sys/devices/system/node/possible"};
+        string range;
+
+        if (!(possible >> range))
+            return 1;
+
+        return stoul(range.substr(range.find_last_of("-,") + 1)) + 1;
+    }
+
+    bool interleavePages(void* memory, size_t bytes)
+    {
+        const size_t nodes = numaNodeCount();
+
+        if (nodes < 2)
+            return false;
+
+        // Mask with bit for each node
+        const size_t bitsInWord = 8 * sizeof(unsigned long);
+        vector<unsigned long> mask((nodes + bitsInWord - 1) / bitsInWord, 0);
+
+        for (size_t node = 0; node < nodes; node++)
+            mask[node / bitsInWord] |= 1UL << (node % bitsInWord);
+
+        return !syscall(SYS_mbind, memory, bytes, INTERLEAVE_POLICY, mask.data(), nodes + 1, 0);
+    }
+
+    vector<size_t> nodeBytes(const void* memory, size_t bytes)
+    {
+        const size_t pageSize = sysconf(_SC_PAGESIZE);
+        const uintptr_t first = reinterpret_cast<uintptr_t>(memory) / pageSize * pageSize;
+        const uintptr_t end = reinterpret_cast<uintptr_t>(memory) + bytes;
+
+        vector<size_t> result(numaNodeCount(), 0);
+        vector<void*> pages;
+        vector<int> status;
+
+        // Ask the kernel for the node of each page, in batches of pages
+        for (uintptr_t batch = first; batch < end; batch += PAGES_BATCH * pageSize)
+        {
+            pages.clear();
+
+            for (uintptr_t page = batch; page < end && pages.size() < PAGES_BATCH; page += pageSize)
+                pages.push_back(reinterpret_cast<void*>(page));
+
+            status.assign(pages.size(), -1);
+
+            // Without target nodes, move_pages only reports where each page is
+            if (syscall(SYS_move_pages, 0, pages.size(), pages.data(), nullptr, status.data(), 0) < 0)
+                return result;
+
+            // Negative status means page that not touched yet (or other error)
+            for (size_t i = 0; i < pages.size(); i++)
+                if (status[i] >= 0)
+                {
+                    if ((size_t)status[i] >= result.size())
+                        result.resize(status[i] + 1, 0);
+
+                    // Count only the part of the page that belongs to the memory
+                    uintptr_t page = reinterpret_cast<uintptr_t>(pages[i]);
+                    result[status[i]] += min<uintptr_t>(page + pageSize, end) -
+                        max<uintptr_t>(page, reinterpret_cast<uintptr_t>(memory));
+                }
+        }
+
+        return result;
+    }
+}
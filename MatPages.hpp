@@ -0,0 +1,66 @@
+// liorbrown@outlook.co.il
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+using namespace std;
+
+namespace Matrix{
+
+    // ---------------- Memory pages helpers ----------------------
+    // Matrices memory that is mapped directly from the kernel, instead of the heap,
+    // so it can use huge pages, and be placed on NUMA nodes
+
+    /// @brief Round size up to whole huge pages
+    /// @param bytes Size to round
+    /// @return The rounded size
+    size_t hugePagesLength(size_t bytes);
+
+    /// @brief Read how many bytes of reserved hugetlbfs pages are free right now
+    /// @return Free bytes in the default huge page size, 0 if there are no such
+    size_t freeReservedBytes();
+
+    /// @brief Check whether the kernel gives transparent huge pages to memory marked by madvise
+    /// @return True - if the mode is always or madvise, False - if it is never, or kernel has no such
+    bool transparentHugePagesEnabled();
+
+    /// @brief Map zeroed memory that is backed by huge pages where available, aligned to huge page.
+    /// The backing is chosen in this order:
+    /// 1. Reserved hugetlbfs pages, if /proc/meminfo has enough free ones (HugePages_Free)
+    /// 2. Transparent huge pages (by madvise), if /sys/kernel/mm/transparent_hugepage/enabled is not never
+    /// 3. Regular pages
+    /// @param bytes Size of wanted memory
+    /// @param hugeTlb Set to true if memory taken from hugetlbfs, and false otherwise
+    /// @return Pointer to the mapped memory, its length is rounded up to whole huge pages
+    void* mapHugePages(size_t bytes, bool& hugeTlb);
+
+    /// @brief Map zeroed memory in regular pages, that not touched yet
+    /// @param bytes Size of wanted memory
+    /// @return Pointer to the mapped memory
+    void* mapPages(size_t bytes);
+
+    /// @brief Read from the kernel how many bytes of given mapping are in transparent huge pages
+    /// @param address Address inside the mapping
+    /// @return Number of bytes in huge pages, of the whole mapping that contains the address
+    size_t transparentHugeBytes(const void* address);
+
+    /// @brief Get number of NUMA nodes that the system may have
+    /// @return Number of nodes, 1 on system without NUMA
+    size_t numaNodeCount();
+
+    /// @brief Ask the kernel to spread the pages of given memory over all NUMA nodes.
+    /// Must be called before the memory is touched
+    /// @param memory Memory to spread, must start on page boundary
+    /// @param bytes Size of the memory
+    /// @return True - if the kernel accepted, False - otherwise (like system without NUMA)
+    bool interleavePages(void* memory, size_t bytes);
+
+    /// @brief Get how many bytes of given memory are on each NUMA node.
+    /// Pages that not touched yet are not on any node, so they not counted
+    /// @param memory Memory to check
+    /// @param bytes Size of the memory
+    /// @return Number of bytes on each node, indexed by node number
+    vector<size_t> nodeBytes(const void* memory, size_t bytes);
+}
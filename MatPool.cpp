@@ -0,0 +1,103 @@
+// liorbrown@outlook.co.il
+
+#include <new>
+#include "MatPool.hpp"
+#include "SquareMat.hpp"
+
+namespace Matrix{
+
+    /// @brief Set when the thread pool destroyed, so late frees not use it
+    static thread_local bool poolDestroyed = false;
+
+    MatPool::MatPool() : enabled(false), maxBlocks(DEFAULT_MAX_BLOCKS), maxBytes(DEFAULT_MAX_BYTES),
+        cachedBytes(0), hits(0), misses(0) {}
+
+    MatPool::~MatPool()
+    {
+        this->clear();
+        poolDestroyed = true;
+    }
+
+    MatPool* MatPool::local()
+    {
+        // Created on first use in each thread
+        static thread_local MatPool pool;
+
+        return poolDestroyed ? nullptr : &pool;
+    }
+
+    void MatPool::setEnabled(bool enabled)
+    {
+        this->enabled = enabled;
+
+        if (!enabled)
+            this->clear();
+    }
+
+    void MatPool::setLimits(size_t maxBlocks, size_t maxBytes)
+    {
+        this->maxBlocks = maxBlocks;
+        this->maxBytes = maxBytes;
+
+        // Free blocks above new limits, from the buckets ends
+        for (auto& [bytes, blocks] : this->buckets)
+            while (!blocks.empty() && (blocks.size() > maxBlocks || this->cachedBytes > maxBytes))
+            {
+                ::operator delete(blocks.back(), align_val_t{SquareMat::ALIGNMENT});
+                blocks.pop_back();
+                this->cachedBytes -= bytes;
+            }
+    }
+
+    void* MatPool::acquire(size_t bytes)
+    {
+        if (this->enabled)
+        {
+            auto bucket = this->buckets.find(bytes);
+
+            // Take the last freed block in this size, that probably still in the cache
+            if (bucket != this->buckets.end() && !bucket->second.empty())
+            {
+                void* result = bucket->second.back();
+                bucket->second.pop_back();
+                this->cachedBytes -= bytes;
+                this->hits++;
+
+                return result;
+            }
+
+            this->misses++;
+        }
+
+        return ::operator new(bytes, align_val_t{SquareMat::ALIGNMENT});
+    }
+
+    void MatPool::recycle(void* memory, size_t bytes)
+    {
+        // Keep block only if pool enabled and limits allow it
+        if (this->enabled && this->cachedBytes + bytes <= this->maxBytes)
+        {
+            vector<void*>& bucket = this->buckets[bytes];
+
+            if (bucket.size() < this->maxBlocks)
+            {
+                bucket.push_back(memory);
+                this->cachedBytes += bytes;
+
+                return;
+            }
+        }
+
+        ::operator delete(memory, align_val_t{SquareMat::ALIGNMENT});
+    }
+
+    void MatPool::clear()
+    {
+        for (auto& [bytes, blocks] : this->buckets)
+            for (void* block : blocks)
+                ::operator delete(block, align_val_t{SquareMat::ALIGNMENT});
+
+        this->buckets.clear();
+        this->cachedBytes = 0;
+    }
+}
@@ -0,0 +1,100 @@
+// liorbrown@outlook.co.il
+
+#pragma once
+
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+namespace Matrix{
+
+    /// @brief This class represents a per-thread pool of matrices heap memory.
+    /// When the pool is enabled, freed matrix memory is kept in a bucket of its size,
+    /// and new matrix in the same size takes it from there instead of the global heap.
+    /// The pool is disabled by default, and each thread has its own pool (see local())
+    class MatPool{
+        private:
+
+            /// @brief Whether freed memory is kept in the pool
+            bool enabled;
+
+            /// @brief Maximal number of blocks that kept in each size bucket
+            size_t maxBlocks;
+
+            /// @brief Maximal number of bytes that kept in all the buckets together
+            size_t maxBytes;
+
+            /// @brief Number of bytes that kept in all the buckets together
+            size_t cachedBytes;
+
+            /// @brief Number of requests that served from the pool
+            size_t hits;
+
+            /// @brief Number of requests that were not found in the pool
+            size_t misses;
+
+            /// @brief Free blocks, bucketed by their size in bytes
+            unordered_map<size_t, vector<void*>> buckets;
+
+            /// @brief Ctor - creates disabled pool, only local() creates pools
+            MatPool();
+
+        public:
+
+            /// @brief Default maximal number of blocks that kept in each size bucket
+            static constexpr size_t DEFAULT_MAX_BLOCKS = 8;
+
+            /// @brief Default maximal number of bytes that kept in the pool
+            static constexpr size_t DEFAULT_MAX_BYTES = 64 << 20;
+
+            /// @brief Dtor - free all kept blocks
+            ~MatPool();
+
+            MatPool(const MatPool& other) = delete;
+            MatPool& operator=(const MatPool& other) = delete;
+
+            /// @brief Get the pool of the calling thread
+            /// @return The thread pool, or nullptr while the thread is exiting
+            static MatPool* local();
+
+            /// @brief Enable or disable the pool. Disabling it free all kept blocks
+            /// @param enabled True - for keep freed blocks, False - otherwise
+            void setEnabled(bool enabled);
+
+            bool isEnabled() const {return this->enabled;}
+
+            /// @brief Set limits of the pool, blocks that freed above them go to the global heap.
+            /// Blocks that already kept above the new limits are freed
+            /// @param maxBlocks Maximal number of blocks in each size bucket
+            /// @param maxBytes Maximal number of bytes in all buckets together
+            void setLimits(size_t maxBlocks, size_t maxBytes);
+
+            /// @brief Get block of memory in given size, from the pool if there is one,
+            /// otherwise from the global heap
+            /// @param bytes Size of the wanted block
+            /// @return Pointer to block that aligned to SquareMat::ALIGNMENT
+            void* acquire(size_t bytes);
+
+            /// @brief Return block to the pool, or to the global heap if pool is full or disabled
+            /// @param memory Block that was got from acquire()
+            /// @param bytes Size of the block
+            void recycle(void* memory, size_t bytes);
+
+            /// @brief Free all kept blocks
+            void clear();
+
+            /// @brief Get number of acquires that served from the pool
+            size_t getHits() const {return this->hits;}
+
+            /// @brief Get number of acquires while pool enabled, that had to use the global heap
+            size_t getMisses() const {return this->misses;}
+
+            /// @brief Get number of bytes that kept in the pool
+            size_t getCachedBytes() const {return this->cachedBytes;}
+
+            /// @brief Reset hits and misses counters
+            void resetStats() {this->hits = this->misses = 0;}
+    };
+}
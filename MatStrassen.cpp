@@ -0,0 +1,200 @@
+// liorbrown@outlook.co.il
+
+#include <atomic>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+#include "MatStrassen.hpp"
+#include "MatGemm.hpp"
+
+namespace Matrix{
+
+    static atomic<MultiplyPolicy> policy{MultiplyPolicy::Blocked};
+
+    static atomic<size_t> crossover{DEFAULT_STRASSEN_CROSSOVER};
+
+    /// @brief Workspace of this thread, it grows once and reused by next multiplications
+    static thread_local vector<double> workspace;
+
+    void setMultiplyPolicy(MultiplyPolicy policy)
+    {
+        Matrix::policy = policy;
+    }
+
+    MultiplyPolicy getMultiplyPolicy()
+    {
+        return policy;
+    }
+
+    void setStrassenCrossover(size_t size)
+    {
+        if (!size)
+            throw invalid_argument("Crossover size must be positive 🫤");
+
+        crossover = size;
+    }
+
+    size_t getStrassenCrossover()
+    {
+        return crossover;
+    }
+
+    /// @brief Write sum of 2 blocks into third one, that may be one of them
+    static void add(const SquareMatView& result, const ConstSquareMatView& left, const ConstSquareMatView& right)
+    {
+        for (size_t i = 0; i < result.getSize(); i++)
+        {
+            double* row = result[i];
+            const double* leftRow = left[i];
+            const double* rightRow = right[i];
+
+            for (size_t j = 0; j < result.getSize(); j++)
+                row[j] = leftRow[j] + rightRow[j];
+        }
+    }
+
+    /// @brief Write subtraction of 2 blocks into third one, that may be one of them
+    static void subtract(const SquareMatView& result, const ConstSquareMatView& left, const ConstSquareMatView& right)
+    {
+        for (size_t i = 0; i < result.getSize(); i++)
+        {
+            double* row = result[i];
+            const double* leftRow = left[i];
+            const double* rightRow = right[i];
+
+            for (size_t j = 0; j < result.getSize(); j++)
+                row[j] = leftRow[j] - rightRow[j];
+        }
+    }
+
+    /// @brief One level of Strassen-Winograd recursion, in the schedule of Boyer, Dumas, Pernet and Zhou,
+    /// that keeps the partial products in the result quadrants, and needs only 2 temporary blocks
+    /// @param a Left operand, its size is the crossover times power of 2
+    /// @param b Right operand
+    /// @param c Result
+    /// @param crossover Size that blocks up to it are multiplied by the blocked kernel
+    /// @param temps Workspace for the temporary blocks of this level and the deeper ones
+    static void strassen(const ConstSquareMatView& a, const ConstSquareMatView& b, const SquareMatView& c,
+        size_t crossover, double* temps)
+    {
+        const size_t size = a.getSize();
+
+        if (size <= crossover)
+        {
+            multiply(a, b, c);
+            return;
+        }
+
+        const size_t half = size / 2;
+
+        const ConstSquareMatView a11 = a.block(0, 0, half), a12 = a.block(0, half, half);
+        const ConstSquareMatView a21 = a.block(half, 0, half), a22 = a.block(half, half, half);
+        const ConstSquareMatView b11 = b.block(0, 0, half), b12 = b.block(0, half, half);
+        const ConstSquareMatView b21 = b.block(half, 0, half), b22 = b.block(half, half, half);
+        const SquareMatView c11 = c.block(0, 0, half), c12 = c.block(0, half, half);
+        const SquareMatView c21 = c.block(half, 0, half), c22 = c.block(half, half, half);
+
+        const SquareMatView x{temps, half, half};
+        const SquareMatView y{temps + half * half, half, half};
+        double* deeper = temps + 2 * half * half;
+
+        subtract(x, a11, a21);              // S3
+        subtract(y, b22, b12);              // T3
+        strassen(x, y, c21, crossover, deeper);       // P7
+        add(x, a21, a22);                   // S1
+        subtract(y, b12, b11);              // T1
+        strassen(x, y, c22, crossover, deeper);       // P5
+        subtract(x, x, a11);                // S2
+        subtract(y, b22, y);                // T2
+        strassen(x, y, c12, crossover, deeper);       // P6
+        subtract(x, a12, x);                // S4
+        strassen(x, b22, c11, crossover, deeper);     // P3
+        strassen(a11, b11, x, crossover, deeper);     // P1
+        add(c12, x, c12);                   // U2 = P1 + P6
+        add(c21, c12, c21);                 // U3 = U2 + P7
+        add(c12, c12, c22);                 // U4 = U2 + P5
+        add(c22, c21, c22);                 // U7 = U3 + P5
+        add(c12, c12, c11);                 // U5 = U4 + P3
+        subtract(y, y, b21);                // T4
+        strassen(a22, y, c11, crossover, deeper);     // P4
+        subtract(c21, c21, c11);            // U6 = U3 - P4
+        strassen(a12, b21, c11, crossover, deeper);   // P2
+        add(c11, x, c11);                   // U1 = P1 + P2
+    }
+
+    /// @brief Copy block into bigger one, and zero the rest of it
+    static void pad(const SquareMatView& padded, const ConstSquareMatView& block)
+    {
+        const size_t size = block.getSize();
+
+        for (size_t i = 0; i < padded.getSize(); i++)
+        {
+            double* row = padded[i];
+            size_t copied = 0;
+
+            if (i < size)
+            {
+                memcpy(row, block[i], size * sizeof(double));
+                copied = size;
+            }
+
+            memset(row + copied, 0, (padded.getSize() - copied) * sizeof(double));
+        }
+    }
+
+    void multiplyStrassen(const ConstSquareMatView& a, const ConstSquareMatView& b, const SquareMatView& c, size_t crossover)
+    {
+        const size_t size = a.getSize();
+
+        if (b.getSize() != size || c.getSize() != size)
+            throw invalid_argument("Matrices sizes not fit to by multipied 🫤");
+
+        if (!crossover)
+            throw invalid_argument("Crossover size must be positive 🫤");
+
+        // Halve the size until it is under the crossover, rounding up,
+        // then the padded size splits evenly in all levels
+        size_t leaf = size;
+        size_t levels = 0;
+
+        while (leaf > crossover)
+        {
+            leaf = (leaf + 1) / 2;
+            levels++;
+        }
+
+        const size_t padded = leaf << levels;
+
+        // Temporary blocks of all levels: 2 of (size/2)^2, 2 of (size/4)^2 ...
+        size_t temps = 0;
+
+        for (size_t level = 1; level <= levels; level++)
+            temps += 2 * (padded >> level) * (padded >> level);
+
+        const size_t copies = (padded == size) ? 0 : 3 * padded * padded;
+
+        if (workspace.size() < temps + copies)
+            workspace.resize(temps + copies);
+
+        double* memory = workspace.data();
+
+        if (!copies)
+        {
+            strassen(a, b, c, crossover, memory);
+            return;
+        }
+
+        // Multiply padded copies, and copy the result back
+        const SquareMatView paddedA{memory, padded, padded};
+        const SquareMatView paddedB{memory + padded * padded, padded, padded};
+        const SquareMatView paddedC{memory + 2 * padded * padded, padded, padded};
+
+        pad(paddedA, a);
+        pad(paddedB, b);
+
+        strassen(paddedA, paddedB, paddedC, crossover, memory + copies);
+
+        for (size_t i = 0; i < size; i++)
+            memcpy(c[i], paddedC[i], size * sizeof(double));
+    }
+}
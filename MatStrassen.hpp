@@ -0,0 +1,51 @@
+// liorbrown@outlook.co.il
+
+#pragma once
+
+#include <cstddef>
+#include "SquareMatView.hpp"
+
+using namespace std;
+
+namespace Matrix{
+
+    // ---------------- Strassen multiplication ----------------------
+    // Strassen-Winograd recursion makes 7 half size products (instead of 8) and 15 additions
+    // in each level, so each level saves about 1/8 of the work, on the cost of bit bigger
+    // rounding errors. Blocks under the crossover are multiplied by the blocked kernel
+
+    /// @brief How matrix multiplication operators multiply
+    enum class MultiplyPolicy{
+        /// @brief Always by the blocked kernel (see MatGemm.hpp)
+        Blocked,
+
+        /// @brief By Strassen recursion, for matrices bigger than the crossover
+        Strassen
+    };
+
+    /// @brief Default size, that blocks up to it are not split anymore
+    constexpr size_t DEFAULT_STRASSEN_CROSSOVER = 1024;
+
+    /// @brief Set how matrix multiplication operators multiply, the default is Blocked
+    /// @param policy The new policy
+    void setMultiplyPolicy(MultiplyPolicy policy);
+
+    MultiplyPolicy getMultiplyPolicy();
+
+    /// @brief Set size, that blocks up to it are multiplied by the blocked kernel
+    /// @param size The new crossover, must be positive
+    void setStrassenCrossover(size_t size);
+
+    size_t getStrassenCrossover();
+
+    /// @brief Multiply 2 square blocks into third one by Strassen recursion.
+    /// Sizes that not split evenly down to the crossover are padded with zeros.
+    /// All the temporary blocks are taken from one workspace, that kept for next calls.
+    /// Result must not overlap the operands
+    /// @param a Left operand
+    /// @param b Right operand
+    /// @param c Result, in the same size, its cells are overridden with a * b
+    /// @param crossover Size that blocks up to it are multiplied by the blocked kernel
+    void multiplyStrassen(const ConstSquareMatView& a, const ConstSquareMatView& b, const SquareMatView& c,
+        size_t crossover = getStrassenCrossover());
+}
@@ -0,0 +1,194 @@
+// liorbrown@outlook.co.il
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Parallel.hpp"
+
+namespace Matrix{
+
+    /// @brief Number of threads that set by the user, 0 means number of hardware threads
+    static atomic<size_t> threadCount{0};
+
+    /// @brief This class represents pool of worker threads, that run queued tasks.
+    /// Workers are created on demand, and kept until the program ends
+    class WorkerPool{
+        private:
+
+            mutex lock;
+
+            /// @brief Signaled when task is queued, or when pool is stopped
+            condition_variable queued;
+
+            /// @brief Signaled when task is done
+            condition_variable done;
+
+            deque<function<void()>> tasks;
+
+            vector<thread> workers;
+
+            bool stopped = false;
+
+            /// @brief Worker thread loop, runs tasks until pool is stopped
+            void work()
+            {
+                unique_lock<mutex> guard{this->lock};
+
+                while (true)
+                {
+                    this->queued.wait(guard, [this]{return this->stopped || !this->tasks.empty();});
+
+                    if (this->tasks.empty())
+                        return;
+
+                    this->runOne(guard);
+                }
+            }
+
+            /// @brief Run the first queued task, without holding the lock while it runs
+            /// @param guard The held lock
+            void runOne(unique_lock<mutex>& guard)
+            {
+                function<void()> task = std::move(this->tasks.front());
+                this->tasks.pop_front();
+
+                guard.unlock();
+                task();
+                guard.lock();
+
+                this->done.notify_all();
+            }
+
+        public:
+
+            ~WorkerPool()
+            {
+                {
+                    lock_guard<mutex> guard{this->lock};
+                    this->stopped = true;
+                }
+
+                this->queued.notify_all();
+
+                for (thread& worker : this->workers)
+                    worker.join();
+            }
+
+            /// @brief Run tasks on the workers and the calling thread, and wait until all of them are done.
+            /// The calling thread runs the first task, and while waiting it runs queued tasks too,
+            /// so parallel work inside task not waits forever for busy workers.
+            /// If tasks throw, all the others still run to the end, and then the first exception
+            /// is thrown to the caller
+            /// @param count Number of tasks
+            /// @param task Function that runs task by its index
+            void run(size_t count, const function<void(size_t index)>& task)
+            {
+                atomic<size_t> remaining{count - 1};
+                exception_ptr failure;
+                unique_lock<mutex> guard{this->lock};
+
+                // Exception must not leave the task: on worker it would end the program,
+                // and on this thread it would free the locals that queued tasks still use
+                auto guarded = [this, &task, &failure](size_t index)
+                {
+                    try
+                    {
+                        task(index);
+                    }
+                    catch (...)
+                    {
+                        lock_guard<mutex> failureGuard{this->lock};
+
+                        if (!failure)
+                            failure = current_exception();
+                    }
+                };
+
+                // Need worker for each task, except of the first one
+                while (this->workers.size() < count - 1)
+                    this->workers.emplace_back(&WorkerPool::work, this);
+
+                for (size_t i = 1; i < count; i++)
+                    this->tasks.push_back([&guarded, &remaining, i]
+                    {
+                        guarded(i);
+                        remaining--;
+                    });
+
+                this->queued.notify_all();
+
+                guard.unlock();
+                guarded(0);
+                guard.lock();
+
+                while (remaining)
+                {
+                    if (!this->tasks.empty())
+                        this->runOne(guard);
+                    else
+                        this->done.wait(guard);
+                }
+
+                if (failure)
+                    rethrow_exception(failure);
+            }
+    };
+
+    /// @brief Get the pool of all the threads
+    /// @return The pool
+    static WorkerPool& workerPool()
+    {
+        static WorkerPool pool;
+
+        return pool;
+    }
+
+    void setThreadCount(size_t threads)
+    {
+        threadCount = threads;
+    }
+
+    size_t getThreadCount()
+    {
+        size_t result = threadCount;
+
+        if (!result)
+            result = thread::hardware_concurrency();
+
+        return result ? result : 1;
+    }
+
+    void rowsBlock(size_t rows, size_t threads, size_t thread, size_t& begin, size_t& end)
+    {
+        // Blocks sizes differ at most by one row
+        begin = rows * thread / threads;
+        end = rows * (thread + 1) / threads;
+    }
+
+    void parallelRows(size_t rows, size_t threads, const function<void(size_t begin, size_t end)>& work)
+    {
+        // No need for more threads than rows
+        threads = min(threads, rows);
+
+        if (threads <= 1)
+        {
+            if (rows)
+                work(0, rows);
+
+            return;
+        }
+
+        // The calling thread works on the first block, and the pool on the others
+        workerPool().run(threads, [&](size_t index)
+        {
+            size_t begin, end;
+            rowsBlock(rows, threads, index, begin, end);
+
+            work(begin, end);
+        });
+    }
+}
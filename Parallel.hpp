@@ -0,0 +1,40 @@
+// liorbrown@outlook.co.il
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+using namespace std;
+
+namespace Matrix{
+
+    // ---------------- Parallel work helpers ----------------------
+    // All parallel work on matrices splits rows by parallelRows(). The workers are not pinned
+    // to cores, and take the blocks from one queue, so block may run on other thread each call
+
+    /// @brief Set number of threads that parallel work uses
+    /// @param threads Number of threads, 0 means number of hardware threads
+    void setThreadCount(size_t threads);
+
+    /// @brief Get number of threads that parallel work uses
+    /// @return Number of threads, at least 1
+    size_t getThreadCount();
+
+    /// @brief Get the rows block of given thread, when rows are split to contiguous blocks
+    /// @param rows Number of rows to split
+    /// @param threads Number of threads
+    /// @param thread Index of the thread
+    /// @param begin Set to the first row of the block
+    /// @param end Set to one after the last row of the block
+    void rowsBlock(size_t rows, size_t threads, size_t thread, size_t& begin, size_t& end);
+
+    /// @brief Run function on all rows, split to contiguous blocks between the threads.
+    /// The calling thread works on the first block, and the other blocks run on pool
+    /// of worker threads, that created on first use and kept for next calls.
+    /// If work throws on any block, the other blocks still run, and then the first exception is thrown
+    /// @param rows Number of rows to split
+    /// @param threads Number of threads
+    /// @param work Function that works on rows block [begin, end)
+    void parallelRows(size_t rows, size_t threads, const function<void(size_t begin, size_t end)>& work);
+}
@@ -1,34 +1,262 @@
 // liorbrown@outlook.co.il
 
 #include <stdexcept>
+#include <algorithm>
 #include <cmath>
+#include <cstring>
+#include <cstdint>
+#include <new>
+#include <system_error>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include "SquareMat.hpp"
+#include "MatArena.hpp"
+#include "MatPool.hpp"
+#include "MatPages.hpp"
+#include "Parallel.hpp"
+#include "MatGemm.hpp"
+#include "MatStrassen.hpp"
+#include "MatBlas.hpp"
 
 namespace Matrix{
-    SquareMat::SquareMat(size_t size) : size(size){
+    atomic<size_t> SquareMat::hugePageThreshold{DEFAULT_HUGE_PAGE_THRESHOLD};
+    atomic<SquareMat::Placement> SquareMat::placement{Placement::Local};
+
+    SquareMat::SquareMat(size_t size) : size(size), stride(0){
         if (!size)
             throw invalid_argument("Matrix size must be positive 🫤");
 
         this->allocateMem();
     }
 
+    SquareMat::SquareMat(size_t size, UninitializedTag) : size(size), stride(0){
+        if (!size)
+            throw invalid_argument("Matrix size must be positive 🫤");
+
+        this->allocateMem(false);
+    }
+
+    SquareMat::SquareMat(size_t size, FillTag, double value) : SquareMat(size, Uninitialized){
+        // Fill each row, the padding is already zero
+        for (size_t i = 0; i < this->size; i++)
+        {
+            double* row = this->mat + i * this->stride;
+
+            fill(row, row + this->size, value);
+        }
+    }
+
+    SquareMat::SquareMat(size_t size, IdentityTag) : SquareMat(size, Uninitialized){
+        // Zero each row and set its diagonal cell, while the row is in the cache
+        for (size_t i = 0; i < this->size; i++)
+        {
+            double* row = this->mat + i * this->stride;
+
+            memset(row, 0, this->size * sizeof(double));
+            row[i] = 1.0;
+        }
+    }
+
+    SquareMat::SquareMat(size_t size, span<const double> cells) : SquareMat(size, Uninitialized){
+        if (cells.size() != size * size)
+            throw invalid_argument("Number of cells not fit to matrix size 🫤");
+
+        this->copyMem(ConstSquareMatView{cells.data(), size, size});
+    }
+
+    SquareMat::SquareMat(const string& path, size_t size, MapMode mode) : size(size), stride(size){
+        if (!size)
+            throw invalid_argument("Matrix size must be positive 🫤");
+
+        // File rows are not padded, so file holds plain row-major matrix
+        const size_t bytes = size * size * sizeof(double);
+        const bool readWrite = (mode == MapMode::ReadWrite);
+
+        int file = open(path.c_str(), readWrite ? O_RDWR | O_CREAT : O_RDONLY, 0644);
+
+        if (file < 0)
+            throw system_error(errno, generic_category(), "Can't open matrix file 🫤");
+
+        struct stat info;
+
+        if (fstat(file, &info) < 0)
+        {
+            int error = errno;
+            close(file);
+            throw system_error(error, generic_category(), "Can't read matrix file size 🫤");
+        }
+
+        // Writable file that is shorter than the matrix (like new file) is extended with zero cells
+        if ((size_t)info.st_size != bytes && !(readWrite && (size_t)info.st_size < bytes))
+        {
+            close(file);
+            throw invalid_argument("Matrix file not in the matrix size 🫤");
+        }
+
+        if ((size_t)info.st_size < bytes && ftruncate(file, bytes) < 0)
+        {
+            int error = errno;
+            close(file);
+            throw system_error(error, generic_category(), "Can't extend matrix file 🫤");
+        }
+
+        // Read only file is mapped as private copy, so writes to the matrix never reach the file
+        void* memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, readWrite ? MAP_SHARED : MAP_PRIVATE, file, 0);
+        int error = errno;
+
+        // The mapping keeps the file alive, so no need for the descriptor anymore
+        close(file);
+
+        if (memory == MAP_FAILED)
+            throw system_error(error, generic_category(), "Can't map matrix file 🫤");
+
+        this->mat = static_cast<double*>(memory);
+        this->source = Source::Mapped;
+    }
+
+    SquareMat::SquareMat(const SquareMat& other) : size(other.size), stride(0)
+    {
+        if (other.isCopyOnWrite())
+            this->shareMem(other);
+        else
+        {
+            // Copy writes all cells, so no need to zero them first
+            this->allocateMem(false);
+            this->copyMem(other);
+        }
+    }
+
+    SquareMat::SquareMat(SquareMat&& other) noexcept : size(0), stride(0)
+    {
+        this->takeMem(other);
+    }
+
+    SquareMat& SquareMat::operator=(SquareMat&& other) noexcept
+    {
+        // Ensure that not making self assingment
+        if (this != &other)
+        {
+            // File backed matrix keeps its file, so the result persists in it
+            if (this->isMapped() && this->size == other.size)
+                this->copyMem(other);
+            else
+            {
+                this->freeMem();
+                this->takeMem(other);
+            }
+        }
+
+        return *this;
+    }
+
+    void SquareMat::swap(SquareMat& other) noexcept
+    {
+        // Every step only moves heap pointers, or copies small inline matrices
+        SquareMat temp{std::move(other)};
+
+        other.takeMem(*this);
+        this->takeMem(temp);
+    }
+
+    void SquareMat::takeMem(SquareMat& other) noexcept
+    {
+        this->size = other.size;
+        this->stride = other.stride;
+        this->source = other.source;
+        this->arena = other.arena;
+        this->refs = other.refs;
+
+        // Inline memory can't be taken, so copy its cells (at most INLINE_SIZE^2)
+        if (other.isInline())
+        {
+            memcpy(this->inlineMem, other.inlineMem, this->size * this->stride * sizeof(double));
+            this->mat = this->inlineMem;
+        }
+        else
+            this->mat = other.mat;
+
+        // Other matrix not own the memory anymore
+        other.size = other.stride = 0;
+        other.mat = nullptr;
+        other.source = Source::Heap;
+        other.arena = nullptr;
+        other.refs = nullptr;
+    }
+
+    void SquareMat::shareMem(const SquareMat& other)
+    {
+        this->size = other.size;
+        this->stride = other.stride;
+        this->mat = other.mat;
+        this->source = other.source;
+        this->arena = other.arena;
+        this->refs = other.refs;
+
+        (*this->refs)++;
+    }
+
+    void SquareMat::detach()
+    {
+        if (!this->isShared())
+            return;
+
+        // Private copy in copy-on-write mode, that takes the place of this matrix,
+        // and releases the shared memory when destroyed
+        SquareMat copy{this->size, Uninitialized};
+        copy.copyMem(*this);
+        copy.enableCopyOnWrite();
+
+        this->swap(copy);
+    }
+
+    bool SquareMat::enableCopyOnWrite()
+    {
+        // Only memory outside the object, that not belongs to a file, can be shared
+        if (!this->refs && this->source != Source::Inline && this->source != Source::Mapped)
+            this->refs = new atomic<size_t>{1};
+
+        return this->isCopyOnWrite();
+    }
+
     SquareMat& SquareMat::operator=(const SquareMat &other)
     {
         // Ensure that not making self assingment
         if (this != &other)
         {
+            // Matrix in copy-on-write mode is shared, instead of copying it,
+            // unless this matrix is file backed, that must keep its file
+            if (other.isCopyOnWrite() && !this->isMapped())
+            {
+                if (this->mat != other.mat)
+                {
+                    this->freeMem();
+                    this->shareMem(other);
+                }
+
+                return *this;
+            }
+
             // If other matrix is not in the same size, need to free this matrix memory,
             // and allocate new one in the right size.
             // Otherwise n+ot need new allocation,
-            // but only override existing data with new one
-            if (this->size != other.size)
+            // but only override existing data with new one.
+            // Shared memory also can't be overridden, so it replaced with new one
+            if (this->size != other.size || this->isShared())
             {
+                // Copy-on-write mode stays with this matrix
+                const bool copyOnWrite = this->isCopyOnWrite();
+
                 // Need to free memory before update matrix size
                 this->freeMem(); 
                 
                 // Need to allocate new memory after update matrix size
                 this->size = other.size;
-                this->allocateMem();
+                this->allocateMem(false);
+
+                if (copyOnWrite)
+                    this->enableCopyOnWrite();
             }
 
             this->copyMem(other);
@@ -38,140 +266,244 @@ namespace Matrix{
         return *this;
     }
 
-    void SquareMat::allocateMem()
+    size_t SquareMat::paddedStride(const size_t size)
     {
-        // Creates rows array
-        this->mat = new double* [this->size];
-        
-        // Foreach row creates its columns array, and init all cells with zero
-        for (size_t i = 0; i < this->size; i++)
-            this->mat[i] = new double[this->size]{0.0}; 
+        const size_t lineDoubles = ALIGNMENT / sizeof(double);
+
+        // Round row up to whole cache lines, so every row starts on a cache line
+        size_t stride = (size + lineDoubles - 1) / lineDoubles * lineDoubles;
+
+        // Add one more cache line when the rows would conflict in the cache,
+        // so walking down a column spreads over all cache sets
+        if (stride * sizeof(double) % CONFLICT_STRIDE == 0)
+            stride += lineDoubles;
+
+        return stride;
     }
 
-    void SquareMat::freeMem()
+    size_t SquareMat::getAlignment() const
     {
-        if (this->mat)
+        // Lowest set bit of base address and stride (in bytes) is the alignment of all rows
+        size_t bits = reinterpret_cast<uintptr_t>(this->mat) | (this->stride * sizeof(double)) | ALIGNMENT;
+
+        return bits & -bits;
+    }
+
+    void SquareMat::allocateMem(bool zero)
+    {
+        this->stride = paddedStride(this->size);
+
+        const size_t bytes = this->size * this->stride * sizeof(double);
+
+        this->arena = MatArena::getActive();
+
+        // Small matrix use the inline memory, otherwise creates one aligned block for all rows,
+        // from the active arena, or from the thread pool (that falls to the global heap)
+        if (this->size <= INLINE_SIZE)
+        {
+            this->source = Source::Inline;
+            this->arena = nullptr;
+            this->mat = this->inlineMem;
+        }
+        else if (this->arena)
+        {
+            this->source = Source::Arena;
+            this->mat = static_cast<double*>(this->arena->allocate(bytes, ALIGNMENT));
+        }
+        else if (bytes >= hugePageThreshold)
+        {
+            // Big matrix is mapped in huge pages, that already zero
+            bool hugeTlb;
+            this->mat = static_cast<double*>(mapHugePages(bytes, hugeTlb));
+            this->source = hugeTlb ? Source::HugeTlb : Source::HugePages;
+            this->placeMem(bytes);
+
+            return;
+        }
+        else if (bytes >= PLACEMENT_THRESHOLD && placement != Placement::Local)
+        {
+            // Placed matrix is mapped in pages that not touched yet, so they can go to any node
+            this->mat = static_cast<double*>(mapPages(bytes));
+            this->source = Source::Pages;
+            this->placeMem(bytes);
+
+            return;
+        }
+        else
         {
-            // Free each row's columns array
+            this->source = Source::Heap;
+
+            if (MatPool* pool = MatPool::local())
+                this->mat = static_cast<double*>(pool->acquire(bytes));
+            else
+                this->mat = static_cast<double*>(::operator new(bytes, align_val_t{ALIGNMENT}));
+        }
+
+        // Init all cells (and padding) with zero, or only the padding,
+        // so whole rows are always safe to read
+        if (zero)
+            memset(this->mat, 0, bytes);
+        else if (this->stride > this->size)
             for (size_t i = 0; i < this->size; i++)
-                if (this->mat[i])
-                    delete[] this->mat[i];
-            
-            // Free the rows array
-            delete[] this->mat;
+                memset(this->mat + i * this->stride + this->size, 0, (this->stride - this->size) * sizeof(double));
+    }
+
+    void SquareMat::placeMem(size_t bytes)
+    {
+        // Mapped memory is already zero, but pages get their node only when first touched
+        switch (placement)
+        {
+            case Placement::Local:
+                break;
+
+            case Placement::Interleave:
+                // Kernel spreads the pages on their first touch, system without NUMA just ignores it
+                interleavePages(this->mat, bytes);
+                memset(this->mat, 0, bytes);
+                break;
+
+            case Placement::FirstTouch:
+                // Touch the rows blocks from all the threads, so the pages not all land on this node
+                parallelRows(this->size, getThreadCount(), [this](size_t begin, size_t end)
+                {
+                    memset(this->mat + begin * this->stride, 0, (end - begin) * this->stride * sizeof(double));
+                });
+                break;
         }
     }
 
-    void SquareMat::copyMem(const SquareMat &other)
+    void SquareMat::freeMem()
     {
-        if (this->size != other.size)
-            throw invalid_argument("Matrices not in the same size 🫤");
+        const size_t bytes = this->size * this->stride * sizeof(double);
 
-        // Deep copy value of each cell from other to this
-        for (size_t i = 0; i < this->size; i++)
-            for (size_t j = 0; j < this->size; j++)
-                (*this)[i][j] = other[i][j];
+        // Shared memory is freed only by the last matrix that uses it
+        if (this->refs && --(*this->refs) > 0)
+            this->mat = nullptr;
+        else
+            delete this->refs;
+
+        this->refs = nullptr;
+
+        // All rows live in one block, so one release frees them all,
+        // back to the place the block came from
+        if (this->mat)
+            switch (this->source)
+            {
+                case Source::Inline:
+                    break;
+
+                case Source::Arena:
+                    this->arena->release(this->mat);
+                    break;
+
+                case Source::Mapped:
+                case Source::Pages:
+                    munmap(this->mat, bytes);
+                    break;
+
+                case Source::HugePages:
+                case Source::HugeTlb:
+                    munmap(this->mat, hugePagesLength(bytes));
+                    break;
+
+                case Source::Heap:
+                    if (MatPool* pool = MatPool::local())
+                        pool->recycle(this->mat, bytes);
+                    else
+                        ::operator delete(this->mat, align_val_t{ALIGNMENT});
+                    break;
+            }
+
+        this->mat = nullptr;
+        this->source = Source::Heap;
+        this->arena = nullptr;
     }
 
-    double SquareMat::getSum() const
+    size_t SquareMat::getHugePageBytes() const
     {
-        double result = 0;
+        const size_t bytes = this->size * this->stride * sizeof(double);
 
-        // Runs on each cell and summerize all values
-        for (size_t i = 0; i < this->size; i++)
-            for (size_t j = 0; j < this->size; j++)
-                result += (*this)[i][j];
-        
-        return result;
+        switch (this->source)
+        {
+            case Source::HugeTlb:
+                return hugePagesLength(bytes);
+
+            case Source::HugePages:
+                // Mapping may be merged with neighbour one, so count only this matrix part
+                return min(transparentHugeBytes(this->mat), hugePagesLength(bytes));
+
+            default:
+                return 0;
+        }
     }
 
-    SquareMat* SquareMat::getMinor(const size_t col) const
+    vector<size_t> SquareMat::getNodeBytes() const
     {
-        if (this->size == 1)
-            throw invalid_argument("Can't calculate minor for matrix in size 1 🫤");
-        
-        // The minor is always in this size minus one
-        size_t minorSize = this->size - 1;
-        
-        SquareMat* result = new SquareMat(minorSize);
-
-        // Run on each cell of new minor matrix
-        for (size_t i = 0; i < minorSize; i++)
-            for (size_t j = 0; j < minorSize; j++)
-                // This minor is work only for first row, so the row of each cell in minor matrix
-                // contains the value of cell in row i + 1 in origin matrix.
-                // The column index depends if current column less than given column
-                // so take the same column as original,
-                // Oterwise, skip the given column to next one
-                (*result)[i][j] = (*this)[i + 1][j < col ?  j : j + 1];            
-        
-        return result;
+        return nodeBytes(this->mat, this->size * this->stride * sizeof(double));
+    }
+
+    void SquareMat::flush() const
+    {
+        if (this->isMapped() && msync(this->mat, this->size * this->stride * sizeof(double), MS_SYNC) < 0)
+            throw system_error(errno, generic_category(), "Can't write matrix file 🫤");
     }
 
-    SquareMat& SquareMat::operator-=(const SquareMat& other)
+    void SquareMat::copyMem(const ConstSquareMatView& other)
     {
-        if (this->size != other.size)
+        if (this->size != other.getSize())
             throw invalid_argument("Matrices not in the same size 🫤");
-        
-        // Runs on each matrix cell, 
-        // and subtruct the value of corresponding cell in other matrix
+
+        // Deep copy each row from other to this
         for (size_t i = 0; i < this->size; i++)
-            for (size_t j = 0; j < this->size; j++)
-                (*this)[i][j] -= other[i][j];                                
+            memcpy(this->mat + i * this->stride, other[i], this->size * sizeof(double));
+    }
+
+    double SquareMat::getSum() const
+    {
+        return ConstSquareMatView{*this}.getSum();
+    }
+
+    SquareMat& SquareMat::operator-=(const ConstSquareMatView& other)
+    {
+        // Subtruct other cells through view on the whole matrix
+        this->detach();
+        SquareMatView{*this} -= other;
         
         return (*this);
     }
 
-    SquareMat& SquareMat::operator+=(const SquareMat& other)
+    SquareMat& SquareMat::operator+=(const ConstSquareMatView& other)
     {
-        if (this->size != other.size)
-            throw invalid_argument("Matrices not in the same size 🫤");
-        
-        // Runs on each matrix cell, 
-        // and add the value of corresponding cell in other matrix
-        for (size_t i = 0; i < this->size; i++)
-            for (size_t j = 0; j < this->size; j++)
-                (*this)[i][j] += other[i][j];                                
+        // Add other cells through view on the whole matrix
+        this->detach();
+        SquareMatView{*this} += other;
         
         return (*this);
     }
 
-    SquareMat& SquareMat::operator%=(const SquareMat& other)
+    SquareMat& SquareMat::operator%=(const ConstSquareMatView& other)
     {
-        if (this->size != other.size)
-            throw invalid_argument("Matrices not in the same size 🫤");
-        
-        // Runs on each matrix cell, 
-        // and multiply it with the value of corresponding cell in other matrix
-        for (size_t i = 0; i < this->size; i++)
-            for (size_t j = 0; j < this->size; j++)
-                (*this)[i][j] *= other[i][j];                                
+        // Multiply by other cells through view on the whole matrix
+        this->detach();
+        SquareMatView{*this} %= other;
         
         return (*this);
     }
 
     SquareMat& SquareMat::operator%=(const int scalar)
     {
-        if (!scalar)
-            throw invalid_argument("Can't divide by zero 🫤");
-        
-        // Runs on each matrix cell, and modulo it by given scalar
-        for (size_t i = 0; i < this->size; i++)
-            for (size_t j = 0; j < this->size; j++)
-                (*this)[i][j] = fmod((*this)[i][j], scalar);
+        // Modulo each cell through view on the whole matrix
+        this->detach();
+        SquareMatView{*this} %= scalar;
         
         return (*this);
     }
 
     SquareMat& SquareMat::operator/=(const double scalar)
     {
-        if (!scalar)
-            throw invalid_argument("Can't divide by zero 🫤");
-        
-        // Runs on each matrix cell, and divide it by given scalar
-        for (size_t i = 0; i < this->size; i++)
-            for (size_t j = 0; j < this->size; j++)
-                (*this)[i][j] /= scalar;                                
+        // Divide each cell through view on the whole matrix
+        this->detach();
+        SquareMatView{*this} /= scalar;
         
         return (*this);
     }
@@ -180,8 +512,12 @@ namespace Matrix{
     {
         // Runs on each matrix cell, and increase it by 1
         for (size_t i = 0; i < this->size; i++)
+        {
+            double* row = (*this)[i];
+
             for (size_t j = 0; j < this->size; j++)
-                (*this)[i][j]++;
+                row[j]++;
+        }
         
         return (*this);
     }
@@ -202,8 +538,12 @@ namespace Matrix{
     {
         // Runs on each matrix cell, and decrease it by 1
         for (size_t i = 0; i < this->size; i++)
+        {
+            double* row = (*this)[i];
+
             for (size_t j = 0; j < this->size; j++)
-                (*this)[i][j]--;
+                row[j]--;
+        }
         
         return (*this);
     }
@@ -222,34 +562,51 @@ namespace Matrix{
 
     SquareMat& SquareMat::operator*=(const double scalar)
     {
-        // Runs on each matrix cell, and multiply it by scalar
-        for (size_t i = 0; i < this->size; i++)
-            for (size_t j = 0; j < this->size; j++)
-                (*this)[i][j] *= scalar;
+        // Multiply each cell through view on the whole matrix
+        this->detach();
+        SquareMatView{*this} *= scalar;
         
         return (*this);
     }
 
-    SquareMat& SquareMat::operator*=(const SquareMat& other)
+    void SquareMat::multiplyBy(const ConstSquareMatView& other, bool transposed)
     {
-        if (this->size != other.size)
+        if (this->size != other.getSize())
             throw invalid_argument("Matrices sizes not fit to by multipied 🫤");
 
-        // Save copy of origin matrix for needed calculation
-        SquareMat copy{*this};
-                
-        // Runs on each cell this in matrix
-        for (size_t i = 0; i < this->size; i++)
-            for (size_t j = 0; j < this->size; j++)
-            {
-                (*this)[i][j] = 0.0;
+        // Calculate into new matrix, because this matrix cells needed until the end.
+        // The kernel writes every cell, so no need to zero it first
+        SquareMat result{this->size, Uninitialized};
 
-                // Runs on the corresponding row in this matrix,
-                // and corresponding column in other matrix
-                // and sumerrize multiply values
-                for (size_t k = 0; k < this->size; k++)
-                    (*this)[i][j] += (copy[i][k] * other[k][j]);
-            }
+        if (!transposed && getMultiplyPolicy() == MultiplyPolicy::Strassen && this->size > getStrassenCrossover())
+            multiplyStrassen(*this, other, result);
+        else
+            gemm(1.0, *this, other, 0.0, result, false, transposed);
+
+        // File backed matrix keeps its file, so the product is written into its cells
+        if (this->isMapped())
+        {
+            this->copyMem(result);
+            return;
+        }
+
+        // Take result memory (in same copy-on-write mode), and let result free the old one
+        if (this->isCopyOnWrite())
+            result.enableCopyOnWrite();
+
+        this->swap(result);
+    }
+
+    SquareMat& SquareMat::operator*=(const ConstSquareMatView& other)
+    {
+        this->multiplyBy(other, false);
+        
+        return (*this);
+    }
+
+    SquareMat& SquareMat::operator*=(const TransposedView& other)
+    {
+        this->multiplyBy(other.view, true);
         
         return (*this);
     }
@@ -260,7 +617,9 @@ namespace Matrix{
         SquareMat result{this->size};
 
         // Return the subtraction of zero matrix with this matrix
-        return (result -= *this);
+        result -= *this;
+
+        return result;
     }
 
     bool SquareMat::operator==(const SquareMat& other) const
@@ -301,40 +660,42 @@ namespace Matrix{
 
     SquareMat SquareMat::operator^(const size_t exp)
     {
-        SquareMat result{this->size};
-
         // Creates new identity matrix with this matrix size
-        for (size_t i = 0; i < this->size; i++)
-            result[i][i] = 1.0;
-        
+        SquareMat result{this->size, Identity};
+
+        // Strassen and BLAS not read packed panels, so they multiply as usual
+        if ((getMultiplyPolicy() == MultiplyPolicy::Strassen && this->size > getStrassenCrossover()) ||
+            getBackend() == Backend::Blas)
+        {
+            for (size_t i = 0; i < exp; i++)
+                result *= *this;
+
+            return result;
+        }
+
+        // This matrix is the right operand of all the multiplications, so pack it only once,
+        // and multiply back and forth between 2 matrices, instead of allocate new one each time
+        const PackedOperand packed{*this};
+        SquareMat next{this->size, Uninitialized};
+
         // Multiply identity matrix exp times by this matrix
         for (size_t i = 0; i < exp; i++)
-            result *= *this;
-        
+        {
+            multiply(result, packed, next);
+            result.swap(next);
+        }
+
         return result;
     }
 
-    double SquareMat::operator!() const
+    double SquareMat::determinant(DeterminantMethod method) const
     {
-        // This is recursion stop condition
-        if (this->size == 1)
-            return (*this)[0][0];
-        
-        double result = 0;
-
-        // This determinant function calculate always with first row,
-        // So make one loop for each row's cells
-        for (size_t i = 0; i < this->size; i++)
-        {
-            SquareMat* minor = this->getMinor(i);
-
-            // Calculate determinant by recursion call for this cell minor
-            result += (pow(-1, i) * (*this)[0][i] * !(*minor));
+        return ConstSquareMatView{*this}.determinant(method);
+    }
 
-            delete minor;
-        }
-        
-        return result;
+    double SquareMat::operator!() const
+    {
+        return !ConstSquareMatView{*this};
     }
 
     ostream& operator<<(ostream& stream, const SquareMat& mat)
@@ -368,28 +729,73 @@ namespace Matrix{
         return (stream);
     }
 
-    SquareMat operator-(SquareMat left, const SquareMat &right)
+    void swap(SquareMat& left, SquareMat& right) noexcept
+    {
+        left.swap(right);
+    }
+
+    SquareMat operator-(SquareMat left, const ConstSquareMatView& right)
+    {
+        // Substructs right from left copy, and returns the moved left copy
+        left -= right;
+
+        return left;
+    }
+
+    SquareMat operator+(SquareMat left, const ConstSquareMatView& right)
+    {
+        // Adds right to left copy, and returns the moved left copy
+        left += right;
+
+        return left;
+    }
+
+    SquareMat operator*(SquareMat left, const ConstSquareMatView& right)
+    {
+        // Multiply left copy by right, and returns the moved left copy
+        left *= right;
+
+        return left;
+    }
+
+    /// @brief Multiply 2 blocks, each of them may be transposed, into new matrix
+    /// @param left Left block
+    /// @param transLeft Whether to use left transpose
+    /// @param right Right block
+    /// @param transRight Whether to use right transpose
+    /// @return The product
+    static SquareMat multiplyTransposed(const ConstSquareMatView& left, bool transLeft,
+        const ConstSquareMatView& right, bool transRight)
+    {
+        // The kernel writes every cell, and reads transposed blocks while packing them
+        SquareMat result{left.getSize(), Uninitialized};
+
+        gemm(1.0, left, right, 0.0, result, transLeft, transRight);
+
+        return result;
+    }
+
+    SquareMat operator*(const ConstSquareMatView& left, const TransposedView& right)
     {
-        // Substructs right from left copy, and returns copy of left copy
-        return (left -= right);
+        return multiplyTransposed(left, false, right.view, true);
     }
 
-    SquareMat operator+(SquareMat left, const SquareMat &right)
+    SquareMat operator*(const TransposedView& left, const ConstSquareMatView& right)
     {
-        // Adds right to left copy, and returns copy of left copy
-        return (left += right);
+        return multiplyTransposed(left.view, true, right, false);
     }
 
-    SquareMat operator*(SquareMat left, const SquareMat& right)
+    SquareMat operator*(const TransposedView& left, const TransposedView& right)
     {
-        // Multiply left copy by right, and returns copy of left copy
-        return (left *= right);
+        return multiplyTransposed(left.view, true, right.view, true);
     }
 
     SquareMat operator*(SquareMat mat, const double scalar)
     {
-        // Multiply mat copy by scalar, and returns copy of mat copy
-        return (mat *= scalar);
+        // Multiply mat copy by scalar, and returns the moved mat copy
+        mat *= scalar;
+
+        return mat;
     }
 
     SquareMat operator*(const double scalar,const SquareMat& mat)
@@ -398,22 +804,28 @@ namespace Matrix{
         return (mat * scalar);
     }
 
-    SquareMat operator%(SquareMat left, const SquareMat& right)
+    SquareMat operator%(SquareMat left, const ConstSquareMatView& right)
     {
-        // Multiply elements of mat copy by right, and returns copy of left copy
-        return (left %= right);
+        // Multiply elements of mat copy by right, and returns the moved left copy
+        left %= right;
+
+        return left;
     }
 
     SquareMat operator%(SquareMat mat, const int scalar)
     {
-        // Modulo mat copy by scalar, and returns copy of mat copy
-        return (mat %= scalar);
+        // Modulo mat copy by scalar, and returns the moved mat copy
+        mat %= scalar;
+
+        return mat;
     }
 
     SquareMat operator/(SquareMat mat, const double scalar)
     {
-        // Divide mat copy by scalar, and returns copy of mat copy
-        return (mat /= scalar);
+        // Divide mat copy by scalar, and returns the moved mat copy
+        mat /= scalar;
+
+        return mat;
     }
 
     SquareMat operator~(SquareMat mat)
@@ -428,7 +840,7 @@ namespace Matrix{
                 mat[j][i] = temp;
             }                                
         
-        // Returns copy of mat copy
+        // Returns mat copy, moved out without another copy
         return mat;
     }  
 }
\ No newline at end of file
@@ -1,37 +1,170 @@
 // liorbrown@outlook.co.il
 
+#pragma once
+
+#include <atomic>
 #include <cstddef>
 #include <iostream>
+#include <span>
+#include <string>
+#include <vector>
+#include "SquareMatView.hpp"
 
 using namespace std;
 
 namespace Matrix{
 
+    class MatArena;
+
+    // ---------------- Construction tags ----------------------
+    // Pass one of them as second constructor parameter, to choose how new matrix is initialized
+
+    /// @brief Tag type for matrix that its cells are left uninitialized
+    struct UninitializedTag{};
+
+    /// @brief Tag type for matrix that all its cells are set to given value
+    struct FillTag{};
+
+    /// @brief Tag type for identity matrix
+    struct IdentityTag{};
+
+    inline constexpr UninitializedTag Uninitialized{};
+    inline constexpr FillTag Fill{};
+    inline constexpr IdentityTag Identity{};
+
     /// @brief This class represents a real numbers square matrix, 
     /// and it includes operators for performing arithmetic operations on matrices.
     class SquareMat{
+        public:
+
+            /// @brief Alignment (in bytes) of matrix memory, that is one cache line
+            static constexpr size_t ALIGNMENT = 64;
+
+            /// @brief Matrices up to this size are stored inline, without heap allocation
+            static constexpr size_t INLINE_SIZE = ALIGNMENT / sizeof(double);
+
+            /// @brief Size (in bytes) of the huge pages that big matrices are backed by
+            static constexpr size_t HUGE_PAGE = 2 << 20;
+
+            /// @brief Default minimal size (in bytes) of matrix memory that is backed by huge pages,
+            /// that is about the size of 2048x2048 matrix
+            static constexpr size_t DEFAULT_HUGE_PAGE_THRESHOLD = 32 << 20;
+
+            /// @brief How file backed matrix maps its file
+            enum class MapMode{
+                /// @brief File never changes, writes to the matrix stay private to the process
+                ReadOnly,
+
+                /// @brief Writes to the matrix are written back to the file
+                ReadWrite
+            };
+
+            /// @brief On which NUMA nodes the memory of big matrices is placed
+            enum class Placement{
+                /// @brief Constructing thread zeroes all the memory, so it lands on its node
+                Local,
+
+                /// @brief Rows blocks are zeroed in parallel (see parallelRows()), so the pages spread
+                /// over the nodes that the threads run on. Threads are not pinned, so later work
+                /// on a block may run on other node
+                FirstTouch,
+
+                /// @brief Pages are spread round robin over all the nodes
+                Interleave
+            };
+
+            /// @brief Minimal size (in bytes) of matrix memory that placement applies to,
+            /// smaller matrices are always placed locally
+            static constexpr size_t PLACEMENT_THRESHOLD = HUGE_PAGE;
+
         private:
+
+            /// @brief Where matrix memory came from, so it can be returned to the same place
+            enum class Source{Inline, Heap, Arena, Mapped, HugePages, HugeTlb, Pages};
+
+            /// @brief Minimal size (in bytes) of matrix memory that is backed by huge pages
+            static atomic<size_t> hugePageThreshold;
+
+            /// @brief Placement of new big matrices
+            static atomic<Placement> placement;
+
             size_t size;
-            double** mat;
 
-            /// @brief allocate memory for the matrix
-            void allocateMem();
+            /// @brief Distance (in doubles) between the starts of two consecutive rows
+            size_t stride;
+
+            /// @brief Single row-major block that holds all the matrix cells
+            double* mat = nullptr;
+
+            /// @brief Where matrix memory came from
+            Source source = Source::Heap;
+
+            /// @brief The arena that matrix memory was drawn from, if its source is an arena
+            MatArena* arena = nullptr;
+
+            /// @brief Number of matrices that share the memory, in copy-on-write mode,
+            /// or nullptr if matrix is not in this mode
+            atomic<size_t>* refs = nullptr;
+
+            /// @brief Cells of small matrices are stored inside the object itself,
+            /// so they (and their temporaries) never touch the allocator.
+            /// Kept last, so all the fields above fit in the cache line before it
+            alignas(ALIGNMENT) double inlineMem[INLINE_SIZE * INLINE_SIZE];
+
+            /// @brief Row strides (in bytes) that are multiple of this value make a column walk
+            /// reuse only a fraction of the cache sets (and hit 4K aliasing at page multiples)
+            static constexpr size_t CONFLICT_STRIDE = 512;
+
+            /// @brief Calculate row stride for given matrix size, 
+            /// so every row starts on a cache line, and rows not conflict in the cache
+            /// @param size The matrix size
+            /// @return The padded row stride (in doubles)
+            static size_t paddedStride(const size_t size);
+
+            /// @brief allocate memory for the matrix, with padded and aligned rows.
+            /// The memory is drawn from the active arena of this thread, if there is one
+            /// @param zero True - for init all cells with zero, False - for zero only the rows padding,
+            /// for caller that writes all cells by itself
+            void allocateMem(bool zero = true);
+
+            /// @brief Place new mapped memory of the matrix on the NUMA nodes,
+            /// by the current placement, and zero it
+            /// @param bytes Size of the memory
+            void placeMem(size_t bytes);
 
             /// @brief Free matrix memory
             void freeMem();
 
-            /// @brief Copy memory from other natrix to this matrix
+            /// @brief Take other matrix memory into this matrix, that has no memory,
+            /// and leaves other matrix empty.
+            /// Heap memory is taken as is, and inline memory is copied
+            /// @param other Matrix to take memory from it
+            void takeMem(SquareMat& other) noexcept;
+
+            /// @brief Check whether matrix cells are stored inside the object itself
+            /// @return True - if matrix uses inline memory, False - otherwise
+            bool isInline() const {return this->source == Source::Inline;}
+
+            /// @brief Make this matrix share other matrix memory, that is in copy-on-write mode
+            /// @param other Matrix to share its memory
+            void shareMem(const SquareMat& other);
+
+            /// @brief Give this matrix its own copy of the memory, if it shares it with other matrices.
+            /// Called before any change to the matrix cells
+            void detach();
+
+            /// @brief Copy memory from other natrix (or block) to this matrix, row by row
             /// @param other Other matrix to copy data from
-            void copyMem(const SquareMat& other);
+            void copyMem(const ConstSquareMatView& other);
+
+            /// @brief Multiply this matrix by other block, or by its transpose, into new memory
+            /// @param other Other block to multiply by it
+            /// @param transposed Whether to multiply by other transpose
+            void multiplyBy(const ConstSquareMatView& other, bool transposed);
 
             /// @brief Get sum of all matrix numbers
             /// @return The sum of all numbers in the matrix
             double getSum() const;
-
-            /// @brief Get minor of this matrix, for the cell in row 0 and column col
-            /// @param col The column index to do the minor on it
-            /// @return The minor matrix of this matrix for cell (0,col)
-            SquareMat* getMinor(const size_t col) const;
             
         public:
 
@@ -40,39 +173,174 @@ namespace Matrix{
             /// @param size The size of the new matrix
             SquareMat(size_t size);
 
-            /// @brief Copy constructor
+            /// @brief Ctor - creates square matrix with uninitialized cells (only rows padding is zeroed),
+            /// for caller that writes all cells by itself
+            /// @param size The size of the new matrix
+            SquareMat(size_t size, UninitializedTag);
+
+            /// @brief Ctor - creates square matrix that all its cells are set to given value
+            /// @param size The size of the new matrix
+            /// @param value Value of all cells
+            SquareMat(size_t size, FillTag, double value);
+
+            /// @brief Ctor - creates identity matrix in given size
+            /// @param size The size of the new matrix
+            SquareMat(size_t size, IdentityTag);
+
+            /// @brief Ctor - creates square matrix with copy of given cells
+            /// @param size The size of the new matrix
+            /// @param cells size * size cells in row-major order
+            SquareMat(size_t size, span<const double> cells);
+
+            /// @brief Ctor - creates square matrix that its cells are stored in given file,
+            /// as size * size doubles in row-major order. The OS loads the cells on demand,
+            /// so matrix can be bigger than RAM.
+            /// In ReadWrite mode missing file is created (with zero cells), and every change
+            /// to the matrix persists in the file.
+            /// Assigning matrix in other size detaches the matrix from the file
+            /// @param path Path of the file
+            /// @param size The size of the matrix
+            /// @param mode How to map the file
+            SquareMat(const string& path, size_t size, MapMode mode);
+
+            /// @brief Copy constructor. 
+            /// Copy of matrix in copy-on-write mode shares its memory instead of copying it
             /// @param Other matrix to copy from it
-            SquareMat(const SquareMat& other): SquareMat(other.size) {this->copyMem(other);}
+            SquareMat(const SquareMat& other);
 
-            /// @brief Assignment operator
+            /// @brief Ctor - creates matrix with copy of the cells of given view
+            /// @param view Block of cells to copy
+            SquareMat(const ConstSquareMatView& view): SquareMat(view.getSize(), Uninitialized) {this->copyMem(view);}
+
+            /// @brief Move constructor - takes other matrix memory without copying it,
+            /// and leaves other matrix empty
+            /// @param other Matrix to move from it
+            SquareMat(SquareMat&& other) noexcept;
+
+            /// @brief Assignment operator.
+            /// Matrix in copy-on-write mode is shared instead of being copied
             /// @param Other matrix to copy data from it 
             /// @return This matrix
             SquareMat& operator=(const SquareMat& other);
 
+            /// @brief Move assignment operator - takes other matrix memory without copying it.
+            /// File backed matrix copies the cells instead, so they persist in its file.
+            /// If other matrix is in other size, file backed matrix is detached from its file
+            /// (that keeps its last cells) and takes other matrix memory, like any matrix
+            /// @param other Matrix to move from it
+            /// @return This matrix
+            SquareMat& operator=(SquareMat&& other) noexcept;
+
+            /// @brief Exchange content with other matrix, without copying any cell.
+            /// File mapping is exchanged too, so to keep the result of file backed matrix
+            /// in its file, move assign it instead
+            /// @param other Matrix to exchange with
+            void swap(SquareMat& other) noexcept;
+
             /// @brief Dtor - free matrix memory
             ~SquareMat(){ this->freeMem();}
             
             size_t getSize() const {return this->size;} 
 
+            /// @brief Get the distance (in doubles) between the starts of two consecutive rows
+            /// @return The matrix row stride
+            size_t getStride() const {return this->stride;}
+
+            /// @brief Get the alignment (in bytes) that every row start is guaranteed to have,
+            /// so vectorized kernels can know when aligned loads are safe
+            /// @return The largest power of 2 (up to ALIGNMENT) that divides every row address
+            size_t getAlignment() const;
+
+            /// @brief Check whether matrix cells are stored in a mapped file
+            /// @return True - if matrix is file backed, False - otherwise
+            bool isMapped() const {return this->source == Source::Mapped;}
+
+            /// @brief Turn on copy-on-write mode. In this mode copies of the matrix share its memory,
+            /// and each of them gets its own memory only on its first change
+            /// (by self assignment operator, non const [] or non const block()).
+            /// Inline and file backed matrices can't share their memory, so they not change mode
+            /// @return True - if matrix is in copy-on-write mode, False - otherwise
+            bool enableCopyOnWrite();
+
+            /// @brief Check whether matrix is in copy-on-write mode
+            bool isCopyOnWrite() const {return this->refs;}
+
+            /// @brief Check whether matrix shares its memory with other matrices right now
+            bool isShared() const {return this->refs && *this->refs > 1;}
+
+            /// @brief Set minimal size (in bytes) of matrix memory, that is backed by huge pages.
+            /// Such memory is aligned to HUGE_PAGE and taken from reserved hugetlbfs pages when enough are free,
+            /// otherwise marked for transparent huge pages (see mapHugePages()).
+            /// Matrices that use an arena are not affected
+            /// @param bytes The new threshold, SIZE_MAX turns huge pages off
+            static void setHugePageThreshold(size_t bytes) {hugePageThreshold = bytes;}
+
+            static size_t getHugePageThreshold() {return hugePageThreshold;}
+
+            /// @brief Get how many bytes of the matrix memory are actually backed by huge pages,
+            /// as reported by the kernel. Transparent huge pages are given only when memory touched,
+            /// and only if the kernel has free ones
+            /// @return Number of bytes in huge pages, 0 if there are no such
+            size_t getHugePageBytes() const;
+
+            /// @brief Set placement of matrices that created from now on.
+            /// Placed matrices are mapped directly from the kernel, and not use the pool.
+            /// Matrices that use an arena, and matrices under PLACEMENT_THRESHOLD, are not affected
+            /// @param placement The new placement
+            static void setPlacement(Placement placement) {SquareMat::placement = placement;}
+
+            static Placement getPlacement() {return placement;}
+
+            /// @brief Get how many bytes of the matrix memory are on each NUMA node,
+            /// as reported by the kernel
+            /// @return Number of bytes on each node, indexed by node number
+            vector<size_t> getNodeBytes() const;
+
+            /// @brief Write changed cells of file backed matrix to its file, and wait for it.
+            /// Does nothing for other matrices
+            void flush() const;
+
             /// @brief Return matrix row, given row index
-            /// can use it by adding another [] to the return value for get cell data
+            /// can use it by adding another [] to the return value for get cell data.
+            /// Shared matrix gets its own memory first, because the row may be changed
+            /// @param row Index of wanted row
+            /// @return Pointer to the wanted row
+            double* operator[](size_t row) {this->detach(); return this->mat + row * this->stride;}
+
+            /// @brief Return matrix row for reading, given row index
             /// @param row Index of wanted row
             /// @return Pointer to the wanted row
-            double* operator[](size_t row) const {return this->mat[row];}
+            const double* operator[](size_t row) const {return this->mat + row * this->stride;}
+
+            /// @brief Get view on square block of this matrix, without copying it.
+            /// Shared matrix gets its own memory first, because the block may be changed
+            /// @param row Row index of block first cell
+            /// @param col Column index of block first cell
+            /// @param size The size of the block
+            /// @return View on the block
+            SquareMatView block(size_t row, size_t col, size_t size) {return SquareMatView{*this}.block(row, col, size);}
+
+            /// @brief Get view on square block of this matrix for reading, without copying it.
+            /// The cells can't be changed through it, so shared matrix is not detached
+            /// @param row Row index of block first cell
+            /// @param col Column index of block first cell
+            /// @param size The size of the block
+            /// @return Read only view on the block
+            ConstSquareMatView block(size_t row, size_t col, size_t size) const {return ConstSquareMatView{*this}.block(row, col, size);}
 
             // ---------------- Self assignment operators ----------------------
 
             /// @brief Substruct other matrix from this matrix, by substruct value of each cell
             /// by its corresponding cell in the other matrix
-            /// @param other Other matrix to subtruct from this matrix
+            /// @param other Other matrix (or block) to subtruct from this matrix
             /// @return This matrix after subtraction
-            SquareMat& operator-=(const SquareMat& other);
+            SquareMat& operator-=(const ConstSquareMatView& other);
 
             /// @brief Summerize other matrix with this matrix, by Summerize value of each cell
             /// by its corresponding cell in the other matrix
-            /// @param other Other matrix to Summerize to this matrix
+            /// @param other Other matrix (or block) to Summerize to this matrix
             /// @return This matrix after Summerize
-            SquareMat& operator+=(const SquareMat& other);
+            SquareMat& operator+=(const ConstSquareMatView& other);
 
             /// @brief Increase by one every cell in matrix
             /// @return This matrix after increasing
@@ -92,10 +360,16 @@ namespace Matrix{
             /// @return Clone of this matrix before decreasing
             SquareMat operator--(int);
 
-            /// @brief Multipy this matrix by other matrix, using standard matrix multiplication
-            /// @param other Other matrix to muliply by it
+            /// @brief Multipy this matrix by other matrix, using standard matrix multiplication.
+            /// Big matrices may use Strassen recursion, see setMultiplyPolicy()
+            /// @param other Other matrix (or block) to muliply by it
+            /// @return This matrix after muliplying
+            SquareMat& operator*=(const ConstSquareMatView& other);
+
+            /// @brief Multipy this matrix by transpose of other matrix, without copying the transpose
+            /// @param other Other matrix (or block), marked by transposed()
             /// @return This matrix after muliplying
-            SquareMat& operator*=(const SquareMat& other);
+            SquareMat& operator*=(const TransposedView& other);
 
             /// @brief Multipy this matrix by scalar, by multiply each  cell by the scalar
             /// @param scalar The scalar to multliply by 
@@ -114,9 +388,9 @@ namespace Matrix{
 
             /// @brief Multiply this matrix by other matix, by multiply value of each cell
             /// by its corresponding cell in the other matrix
-            /// @param other Other matrix to multiply to this matrix
+            /// @param other Other matrix (or block) to multiply to this matrix
             /// @return This matrix after multiplying
-            SquareMat& operator%=(const SquareMat& other);
+            SquareMat& operator%=(const ConstSquareMatView& other);
             
             // ---------------- Equality operators ----------------------
 
@@ -157,7 +431,12 @@ namespace Matrix{
             /// @return New matrix that represent the minus of this marix
             SquareMat operator-() const;
 
-            /// @brief Return the determinant of this matrix
+            /// @brief Calculate the determinant of this matrix
+            /// @param method How to calculate it, LU factorization or cofactor expansion (see DeterminantMethod)
+            /// @return The determinant of this matrix
+            double determinant(DeterminantMethod method = DeterminantMethod::LU) const;
+
+            /// @brief Return the determinant of this matrix, by LU factorization
             /// @return The determinant of this matrix
             double operator!() const;
 
@@ -169,26 +448,52 @@ namespace Matrix{
 
     // ---------------- Out class operators ----------------------
 
+    /// @brief Exchange content of 2 matrices, without copying any cell
+    /// @param left First matrix to exchange
+    /// @param right Seconed matrix to exchange
+    void swap(SquareMat& left, SquareMat& right) noexcept;
+
     /// @brief Return the subtraction of right matrix from left matrix, by substruct value of each cell
     /// by its corresponding cell in the other matrix
     /// @param left Matrix to subtruct from it
     /// @param right Matrix to subtruct from left matrix
     /// @return New matrix that represent subtraction result
-    SquareMat operator-(SquareMat left, const SquareMat& right);
+    SquareMat operator-(SquareMat left, const ConstSquareMatView& right);
 
     /// @brief Return the Summerize of 2 matrices, by summerize value of each pair of cells
     /// in the corresponding cells
     /// @param left Left matrix to summerize from it
     /// @param right Right matrix to summerize from it
     /// @return New matrix that represent summerize result
-    SquareMat operator+(SquareMat left, const SquareMat& right);
+    SquareMat operator+(SquareMat left, const ConstSquareMatView& right);
 
     /// @brief Return the result of right matrix multliply left matrix, 
     /// using standard matrix multiplication
     /// @param left Matrix to multiply
     /// @param right Matrix to be multiply by
     /// @return New matrix that represent result of matrix multiplication
-    SquareMat operator*(SquareMat left, const SquareMat& right);        
+    SquareMat operator*(SquareMat left, const ConstSquareMatView& right);        
+
+    /// @brief Return the result of left matrix multiply by transpose of right matrix,
+    /// without copying the transpose, or the left matrix
+    /// @param left Matrix to multiply
+    /// @param right Matrix to be multiply by its transpose, marked by transposed()
+    /// @return New matrix that represent result of matrix multiplication
+    SquareMat operator*(const ConstSquareMatView& left, const TransposedView& right);
+
+    /// @brief Return the result of transpose of left matrix multiply by right matrix,
+    /// without copying the transpose, or the right matrix
+    /// @param left Matrix to multiply its transpose, marked by transposed()
+    /// @param right Matrix to be multiply by
+    /// @return New matrix that represent result of matrix multiplication
+    SquareMat operator*(const TransposedView& left, const ConstSquareMatView& right);
+
+    /// @brief Return the result of transpose of left matrix multiply by transpose of right matrix,
+    /// without copying the transposes
+    /// @param left Matrix to multiply its transpose, marked by transposed()
+    /// @param right Matrix to be multiply by its transpose, marked by transposed()
+    /// @return New matrix that represent result of matrix multiplication
+    SquareMat operator*(const TransposedView& left, const TransposedView& right);
 
     /// @brief Return the result of multiply matrix by scalar
     /// @param mat Matrix to multiply
@@ -207,7 +512,7 @@ namespace Matrix{
     /// @param left Matrix to multiply
     /// @param right Matrix to multiply
     /// @return New matrix that represent result of matrices element multiplication
-    SquareMat operator%(SquareMat left, const SquareMat& right);
+    SquareMat operator%(SquareMat left, const ConstSquareMatView& right);
 
     /// @brief Return the result of modulo matrix by scalar, by modulo each cell by given scalar
     /// @param mat Matrix to make modulo
@@ -0,0 +1,95 @@
+// liorbrown@outlook.co.il
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include "SquareMatBatch.hpp"
+#include "MatKernels.hpp"
+#include "Parallel.hpp"
+
+namespace Matrix{
+
+    SquareMatBatch::SquareMatBatch(size_t size, size_t count) :
+        size(size), count(count), lanes((count + LANES - 1) / LANES * LANES), cells(size * size * this->lanes, 0.0)
+    {
+        if (!size)
+            throw invalid_argument("Matrix size must be positive 🫤");
+    }
+
+    void SquareMatBatch::set(size_t index, const ConstSquareMatView& mat)
+    {
+        if (mat.getSize() != this->size)
+            throw invalid_argument("Matrices not in the same size 🫤");
+
+        if (index >= this->count)
+            throw out_of_range("Matrix index is out of batch 🫤");
+
+        for (size_t i = 0; i < this->size; i++)
+            for (size_t j = 0; j < this->size; j++)
+                (*this)(index, i, j) = mat[i][j];
+    }
+
+    SquareMat SquareMatBatch::get(size_t index) const
+    {
+        if (index >= this->count)
+            throw out_of_range("Matrix index is out of batch 🫤");
+
+        SquareMat result{this->size, Uninitialized};
+
+        for (size_t i = 0; i < this->size; i++)
+            for (size_t j = 0; j < this->size; j++)
+                result[i][j] = (*this)(index, i, j);
+
+        return result;
+    }
+
+    void multiply(const SquareMatBatch& left, const SquareMatBatch& right, SquareMatBatch& result)
+    {
+        const size_t size = left.getSize();
+        const size_t count = left.getCount();
+
+        if (right.getSize() != size || result.getSize() != size)
+            throw invalid_argument("Matrices sizes not fit to by multipied 🫤");
+
+        if (right.getCount() != count || result.getCount() != count)
+            throw invalid_argument("Batches not in the same count 🫤");
+
+        if (&result == &left || &result == &right)
+            throw invalid_argument("Result batch can't be one of the operands 🫤");
+
+        const Kernels& kernels = getKernels();
+        const size_t lanes = (count + SquareMatBatch::LANES - 1) / SquareMatBatch::LANES * SquareMatBatch::LANES;
+        const size_t chunks = (lanes + SquareMatBatch::CHUNK - 1) / SquareMatBatch::CHUNK;
+
+        // Chunks of matrices are split between threads, each chunk is multiplied cell by cell,
+        // and each cell sums its products along all the lanes of the chunk together
+        parallelRows(chunks, getThreadCount(), [&](size_t begin, size_t end)
+        {
+            for (size_t chunk = begin; chunk < end; chunk++)
+            {
+                const size_t first = chunk * SquareMatBatch::CHUNK;
+                const size_t length = min(SquareMatBatch::CHUNK, lanes - first);
+
+                for (size_t i = 0; i < size; i++)
+                    for (size_t j = 0; j < size; j++)
+                    {
+                        double* cell = result.cell(i, j) + first;
+
+                        memset(cell, 0, length * sizeof(double));
+
+                        for (size_t k = 0; k < size; k++)
+                            kernels.multiplyAdd(cell, left.cell(i, k) + first, right.cell(k, j) + first, length);
+                    }
+            }
+        });
+    }
+
+    SquareMatBatch operator*(const SquareMatBatch& left, const SquareMatBatch& right)
+    {
+        SquareMatBatch result{left.getSize(), left.getCount()};
+
+        multiply(left, right, result);
+
+        return result;
+    }
+}
@@ -0,0 +1,89 @@
+// liorbrown@outlook.co.il
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include "SquareMat.hpp"
+
+using namespace std;
+
+namespace Matrix{
+
+    /// @brief This class represents batch of same size square matrices, stored as structure of arrays:
+    /// each cell has one contiguous array with its value in all the matrices of the batch.
+    /// So operations on the whole batch run on all the matrices together, each matrix in its own
+    /// SIMD lane, without any allocation or short loop for each matrix
+    class SquareMatBatch{
+        private:
+
+            size_t size;
+
+            /// @brief Number of matrices in the batch
+            size_t count;
+
+            /// @brief Length of each cell array, count rounded up to whole vectors,
+            /// so the kernels never need a scalar tail
+            size_t lanes;
+
+            /// @brief Arrays of all the cells, in row-major order of the cells
+            vector<double> cells;
+
+        public:
+
+            /// @brief Number of matrices that each cell array is rounded up to
+            static constexpr size_t LANES = 8;
+
+            /// @brief Number of matrices that multiplied together, so their cell arrays stay in L1/L2
+            static constexpr size_t CHUNK = 256;
+
+            /// @brief Ctor - creates batch of zero matrices
+            /// @param size The size of each matrix
+            /// @param count Number of matrices
+            SquareMatBatch(size_t size, size_t count);
+
+            size_t getSize() const {return this->size;}
+
+            size_t getCount() const {return this->count;}
+
+            /// @brief Get the array of one cell in all the matrices, to fill or read the batch directly
+            /// @param row Row index of the cell
+            /// @param col Column index of the cell
+            /// @return Pointer to the cell value in the first matrix, the next matrices follow it
+            double* cell(size_t row, size_t col) {return this->cells.data() + (row * this->size + col) * this->lanes;}
+
+            const double* cell(size_t row, size_t col) const {return this->cells.data() + (row * this->size + col) * this->lanes;}
+
+            /// @brief Get cell of one matrix
+            /// @param index Index of the matrix
+            /// @param row Row index of the cell
+            /// @param col Column index of the cell
+            /// @return Reference to the cell
+            double& operator()(size_t index, size_t row, size_t col) {return this->cell(row, col)[index];}
+
+            double operator()(size_t index, size_t row, size_t col) const {return this->cell(row, col)[index];}
+
+            /// @brief Copy matrix (or block) into the batch
+            /// @param index Index of the matrix in the batch
+            /// @param mat Matrix to copy, in the batch size
+            void set(size_t index, const ConstSquareMatView& mat);
+
+            /// @brief Copy matrix out of the batch
+            /// @param index Index of the matrix in the batch
+            /// @return Copy of the matrix
+            SquareMat get(size_t index) const;
+    };
+
+    /// @brief Multiply each matrix of left batch by the matrix in the same index of right batch,
+    /// into result batch that already exists, so no memory is allocated
+    /// @param left Batch of left operands
+    /// @param right Batch of right operands
+    /// @param result Batch of the products, in the same size and count, must not be one of the operands
+    void multiply(const SquareMatBatch& left, const SquareMatBatch& right, SquareMatBatch& result);
+
+    /// @brief Return batch of products of each pair of matrices in the same index
+    /// @param left Batch of left operands
+    /// @param right Batch of right operands
+    /// @return New batch of the products
+    SquareMatBatch operator*(const SquareMatBatch& left, const SquareMatBatch& right);
+}
@@ -0,0 +1,326 @@
+// liorbrown@outlook.co.il
+
+#include <algorithm>
+#include <stdexcept>
+#include "SquareMatF.hpp"
+#include "MatGemm.hpp"
+#include "MatKernels.hpp"
+#include "Parallel.hpp"
+
+namespace Matrix{
+
+    /// @brief Rows that each thread accumulates in double at once. B panels are packed again
+    /// for each chunk, so bigger chunk packs less, but needs bigger rows buffer
+    static constexpr size_t ROWS_CHUNK = 4 * GEMM_MC;
+
+    /// @brief Double buffers of this thread, they grow once and reused by next multiplications.
+    /// A and B buffers hold one packed block of them, and rows buffer one chunk of the result columns block
+    static thread_local vector<double> packedA;
+    static thread_local vector<double> packedB;
+    static thread_local vector<double> rowsBuffer;
+
+    /// @brief Multiply by plain i-k-j loops, each result row accumulated in double, then rounded once
+    static void multiplySmall(const SquareMatF& a, const SquareMatF& b, SquareMatF& c, size_t begin, size_t end)
+    {
+        const size_t size = a.getSize();
+
+        if (rowsBuffer.size() < size)
+            rowsBuffer.resize(size);
+
+        double* row = rowsBuffer.data();
+
+        for (size_t i = begin; i < end; i++)
+        {
+            fill(row, row + size, 0.0);
+
+            for (size_t k = 0; k < size; k++)
+            {
+                const double factor = a[i][k];
+                const float* bRow = b[k];
+
+                for (size_t j = 0; j < size; j++)
+                    row[j] += factor * bRow[j];
+            }
+
+            for (size_t j = 0; j < size; j++)
+                c[i][j] = (float)row[j];
+        }
+    }
+
+    /// @brief Pack KC x NC block of B into double panels of nr columns, each panel row after row,
+    /// like packB() of MatGemm.cpp
+    /// @param nr Columns of each panel
+    /// @param b Right operand
+    /// @param row First row of the block
+    /// @param col First column of the block
+    /// @param depth Rows of the block
+    /// @param cols Columns of the block
+    /// @param packed Buffer to pack into
+    static void packB(size_t nr, const SquareMatF& b, size_t row, size_t col, size_t depth, size_t cols, double* packed)
+    {
+        for (size_t panel = 0; panel < cols; panel += nr)
+        {
+            const size_t panelCols = min(nr, cols - panel);
+
+            for (size_t k = 0; k < depth; k++, packed += nr)
+            {
+                const float* bRow = b[row + k] + col + panel;
+
+                for (size_t j = 0; j < panelCols; j++)
+                    packed[j] = bRow[j];
+
+                for (size_t j = panelCols; j < nr; j++)
+                    packed[j] = 0;
+            }
+        }
+    }
+
+    /// @brief Pack block of A into double panels of mr rows, each panel column after column,
+    /// like packA() of MatGemm.cpp
+    static void packA(size_t mr, const SquareMatF& a, size_t row, size_t col, size_t rows, size_t depth, double* packed)
+    {
+        for (size_t panel = 0; panel < rows; panel += mr)
+        {
+            const size_t panelRows = min(mr, rows - panel);
+
+            for (size_t k = 0; k < depth; k++, packed += mr)
+            {
+                for (size_t r = 0; r < panelRows; r++)
+                    packed[r] = a[row + panel + r][col + k];
+
+                for (size_t r = panelRows; r < mr; r++)
+                    packed[r] = 0;
+            }
+        }
+    }
+
+    /// @brief Multiply rows block of A by B, into the same rows of the result,
+    /// by the loops of the blocked kernel of MatGemm.cpp, while the operands are converted to double
+    /// when packed. The rows are done in chunks, and each columns block of a chunk is accumulated
+    /// in double buffer over all the depth, and then rounded once into the result.
+    /// Every cell sums the same products in the same order, so the result not depends on the rows block
+    static void multiplyRows(const Kernels& kernels, const SquareMatF& a, const SquareMatF& b, SquareMatF& c,
+        size_t begin, size_t end)
+    {
+        const size_t size = a.getSize();
+        const size_t mr = kernels.mr;
+        const size_t nr = kernels.nr;
+
+        // Buffers are rounded up to whole micro panels
+        const size_t chunk = min(ROWS_CHUNK, end - begin);
+        const size_t mc = min(GEMM_MC, (chunk + mr - 1) / mr * mr);
+        const size_t nc = min(GEMM_NC, (size + nr - 1) / nr * nr);
+        const size_t kc = min(GEMM_KC, size);
+
+        if (packedA.size() < mc * kc)
+            packedA.resize(mc * kc);
+
+        if (packedB.size() < kc * nc)
+            packedB.resize(kc * nc);
+
+        if (rowsBuffer.size() < chunk * nc)
+            rowsBuffer.resize(chunk * nc);
+
+        for (size_t first = begin; first < end; first += ROWS_CHUNK)
+        {
+            const size_t last = min(end, first + ROWS_CHUNK);
+
+            // B panel (L3) loop, then depth loop, then A block (L2) loop,
+            // so each packed B panel is used by all A blocks of the chunk
+            for (size_t jc = 0; jc < size; jc += GEMM_NC)
+            {
+                const size_t cols = min(GEMM_NC, size - jc);
+
+                for (size_t pc = 0; pc < size; pc += GEMM_KC)
+                {
+                    const size_t depth = min(GEMM_KC, size - pc);
+
+                    packB(nr, b, pc, jc, depth, cols, packedB.data());
+
+                    for (size_t ic = first; ic < last; ic += GEMM_MC)
+                    {
+                        const size_t rows = min(GEMM_MC, last - ic);
+
+                        packA(mr, a, ic, pc, rows, depth, packedA.data());
+
+                        // The first depth block overrides the buffer, and the next ones add to it
+                        for (size_t jr = 0; jr < cols; jr += nr)
+                            for (size_t ir = 0; ir < rows; ir += mr)
+                                kernels.microKernel(depth, packedA.data() + ir * depth, packedB.data() + jr * depth,
+                                    rowsBuffer.data() + (ic - first + ir) * nc + jr, nc,
+                                    min(mr, rows - ir), min(nr, cols - jr), 1.0, pc ? 1.0 : 0.0);
+                    }
+                }
+
+                // The columns block is done, so round it once into the result
+                for (size_t i = first; i < last; i++)
+                {
+                    const double* row = rowsBuffer.data() + (i - first) * nc;
+                    float* cRow = c[i] + jc;
+
+                    for (size_t j = 0; j < cols; j++)
+                        cRow[j] = (float)row[j];
+                }
+            }
+        }
+    }
+
+    SquareMatF::SquareMatF(size_t size) : size(size), cells(size * size, 0.0f)
+    {
+        if (!size)
+            throw invalid_argument("Matrix size must be positive 🫤");
+    }
+
+    SquareMatF::SquareMatF(size_t size, FillTag, float value) : SquareMatF(size)
+    {
+        fill(this->cells.begin(), this->cells.end(), value);
+    }
+
+    SquareMatF::SquareMatF(size_t size, IdentityTag) : SquareMatF(size)
+    {
+        for (size_t i = 0; i < size; i++)
+            (*this)[i][i] = 1.0f;
+    }
+
+    SquareMatF::SquareMatF(const ConstSquareMatView& mat) : SquareMatF(mat.getSize())
+    {
+        for (size_t i = 0; i < this->size; i++)
+            for (size_t j = 0; j < this->size; j++)
+                (*this)[i][j] = (float)mat[i][j];
+    }
+
+    SquareMatF::operator SquareMat() const
+    {
+        SquareMat result{this->size, Uninitialized};
+
+        for (size_t i = 0; i < this->size; i++)
+            for (size_t j = 0; j < this->size; j++)
+                result[i][j] = (*this)[i][j];
+
+        return result;
+    }
+
+    double SquareMatF::getSum() const
+    {
+        double result = 0;
+
+        for (float cell : this->cells)
+            result += cell;
+
+        return result;
+    }
+
+    SquareMatF& SquareMatF::operator+=(const SquareMatF& other)
+    {
+        if (this->size != other.size)
+            throw invalid_argument("Matrices not in the same size 🫤");
+
+        for (size_t cell = 0; cell < this->cells.size(); cell++)
+            this->cells[cell] += other.cells[cell];
+
+        return (*this);
+    }
+
+    SquareMatF& SquareMatF::operator-=(const SquareMatF& other)
+    {
+        if (this->size != other.size)
+            throw invalid_argument("Matrices not in the same size 🫤");
+
+        for (size_t cell = 0; cell < this->cells.size(); cell++)
+            this->cells[cell] -= other.cells[cell];
+
+        return (*this);
+    }
+
+    SquareMatF& SquareMatF::operator*=(const double scalar)
+    {
+        for (float& cell : this->cells)
+            cell = (float)(cell * scalar);
+
+        return (*this);
+    }
+
+    SquareMatF& SquareMatF::operator*=(const SquareMatF& other)
+    {
+        // Calculate into new matrix, because this matrix cells needed until the end
+        SquareMatF result{this->size};
+
+        multiply(*this, other, result);
+
+        return (*this) = move(result);
+    }
+
+    void multiply(const SquareMatF& a, const SquareMatF& b, SquareMatF& c, size_t threads)
+    {
+        const size_t size = a.getSize();
+
+        if (b.getSize() != size || c.getSize() != size)
+            throw invalid_argument("Matrices sizes not fit to by multipied 🫤");
+
+        if (&c == &a || &c == &b)
+            throw invalid_argument("Result matrix can't be one of the operands 🫤");
+
+        // All threads use the same kernels, so the result not depends on the threads
+        const Kernels& kernels = getKernels();
+
+        if (size < getParallelThreshold())
+            threads = 1;
+        else if (!threads)
+            threads = getThreadCount();
+
+        if (size <= GEMM_SMALL)
+        {
+            multiplySmall(a, b, c, 0, size);
+            return;
+        }
+
+        parallelRows(size, threads, [&](size_t begin, size_t end)
+        {
+            multiplyRows(kernels, a, b, c, begin, end);
+        });
+    }
+
+    SquareMatF operator+(SquareMatF left, const SquareMatF& right)
+    {
+        // Adds right to left copy, and returns the moved left copy
+        left += right;
+
+        return left;
+    }
+
+    SquareMatF operator-(SquareMatF left, const SquareMatF& right)
+    {
+        // Substructs right from left copy, and returns the moved left copy
+        left -= right;
+
+        return left;
+    }
+
+    SquareMatF operator*(const SquareMatF& left, const SquareMatF& right)
+    {
+        SquareMatF result{left.getSize()};
+
+        multiply(left, right, result);
+
+        return result;
+    }
+
+    SquareMatF operator*(SquareMatF mat, const double scalar)
+    {
+        mat *= scalar;
+
+        return mat;
+    }
+
+    SquareMatF operator*(const double scalar, SquareMatF mat)
+    {
+        mat *= scalar;
+
+        return mat;
+    }
+
+    ostream& operator<<(ostream& stream, const SquareMatF& mat)
+    {
+        return stream << SquareMat{mat};
+    }
+}
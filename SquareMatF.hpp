@@ -0,0 +1,117 @@
+// liorbrown@outlook.co.il
+
+#pragma once
+
+#include <cstddef>
+#include <iostream>
+#include <vector>
+#include "SquareMat.hpp"
+
+using namespace std;
+
+namespace Matrix{
+
+    /// @brief This class represents a real numbers square matrix, that its cells stored as float,
+    /// so it takes half of the memory (and memory traffic) of SquareMat.
+    /// Multiplication and sum still accumulate in double, so their only error beyond
+    /// the float cells is one rounding of each result to float:
+    /// for n x n product of the float cells, each cell differs from the all-double product
+    /// of the same cells by at most 2^-24 * |c| + n * 2^-53 * (|A| * |B|) of the cell.
+    /// Compared to double matrices that rounded into float, rounding the operands adds
+    /// up to 2 * 2^-24 * (|A| * |B|) of the cell
+    class SquareMatF{
+        private:
+
+            size_t size;
+
+            /// @brief Cells of the matrix in row-major order, without padding
+            vector<float> cells;
+
+        public:
+
+            /// @brief Ctor - creates zero matrix
+            /// @param size The size of the matrix
+            SquareMatF(size_t size);
+
+            /// @brief Ctor - creates matrix that all its cells are set to given value
+            /// @param size The size of the matrix
+            /// @param value Value of all cells
+            SquareMatF(size_t size, FillTag, float value);
+
+            /// @brief Ctor - creates identity matrix
+            /// @param size The size of the matrix
+            SquareMatF(size_t size, IdentityTag);
+
+            /// @brief Ctor - creates matrix with copy of SquareMat (or block) cells, rounded to float
+            /// @param mat Matrix to copy
+            explicit SquareMatF(const ConstSquareMatView& mat);
+
+            /// @brief Convert to SquareMat with copy of the cells, that is exact
+            operator SquareMat() const;
+
+            size_t getSize() const {return this->size;}
+
+            /// @brief Return matrix row, given row index
+            /// @param row Index of wanted row
+            /// @return Pointer to the wanted row
+            float* operator[](size_t row) {return this->cells.data() + row * this->size;}
+
+            const float* operator[](size_t row) const {return this->cells.data() + row * this->size;}
+
+            /// @brief Get sum of all matrix numbers, that summed in double
+            /// @return The sum of all numbers in the matrix
+            double getSum() const;
+
+            // ---------------- Self assignment operators ----------------------
+
+            SquareMatF& operator+=(const SquareMatF& other);
+
+            SquareMatF& operator-=(const SquareMatF& other);
+
+            SquareMatF& operator*=(const double scalar);
+
+            /// @brief Multipy this matrix by other matrix, using standard matrix multiplication
+            /// that accumulates in double
+            SquareMatF& operator*=(const SquareMatF& other);
+
+            // ---------------- Equality operators ----------------------
+            // Like in SquareMat, they check only the sum of matrices, not their cells values
+
+            bool operator==(const SquareMatF& other) const {return this->getSum() == other.getSum();}
+
+            bool operator!=(const SquareMatF& other) const {return this->getSum() != other.getSum();}
+
+            bool operator<(const SquareMatF& other) const {return this->getSum() < other.getSum();}
+
+            bool operator<=(const SquareMatF& other) const {return this->getSum() <= other.getSum();}
+
+            bool operator>(const SquareMatF& other) const {return this->getSum() > other.getSum();}
+
+            bool operator>=(const SquareMatF& other) const {return this->getSum() >= other.getSum();}
+    };
+
+    /// @brief Multiply 2 float matrices into third one, accumulating in double.
+    /// Each thread converts blocks of both operands to double while packing them, and runs
+    /// the blocked kernel (see MatGemm.hpp) on chunks of its rows, so it keeps only one block
+    /// of each operand and of the result in double, and the result is the same in any number of threads
+    /// @param a Left operand
+    /// @param b Right operand
+    /// @param c Result, in the same size, must not be one of the operands
+    /// @param threads Number of threads, 0 means getThreadCount()
+    void multiply(const SquareMatF& a, const SquareMatF& b, SquareMatF& c, size_t threads = 0);
+
+    // ---------------- Out class operators ----------------------
+
+    SquareMatF operator+(SquareMatF left, const SquareMatF& right);
+
+    SquareMatF operator-(SquareMatF left, const SquareMatF& right);
+
+    SquareMatF operator*(const SquareMatF& left, const SquareMatF& right);
+
+    SquareMatF operator*(SquareMatF mat, const double scalar);
+
+    SquareMatF operator*(const double scalar, SquareMatF mat);
+
+    /// @brief Print the matrix, like SquareMat is printed
+    ostream& operator<<(ostream& stream, const SquareMatF& mat);
+}
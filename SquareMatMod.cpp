@@ -0,0 +1,297 @@
+// liorbrown@outlook.co.il
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include "SquareMatMod.hpp"
+#include "MatGemm.hpp"
+#include "MatKernels.hpp"
+#include "Parallel.hpp"
+
+namespace Matrix{
+
+    /// @brief Row of 64 bit sums of this thread, it grows once and reused by next multiplications
+    static thread_local vector<uint64_t> sums;
+
+    /// @brief Barrett reduction by fixed modulus: x mod m is x - q * m,
+    /// where q is estimated by multiplication with precomputed 2^64 / m instead of division
+    struct Barrett{
+        uint64_t modulus;
+
+        /// @brief floor((2^64 - 1) / modulus)
+        uint64_t inverse;
+
+        explicit Barrett(uint64_t modulus) : modulus(modulus), inverse(UINT64_MAX / modulus) {}
+
+        /// @brief Reduce any 64 bit number
+        /// @param x The number
+        /// @return x mod modulus
+        uint64_t reduce(uint64_t x) const
+        {
+            // The estimate is at most 2 less than x / modulus, so at most 2 corrections
+            const uint64_t quotient = (uint64_t)(((unsigned __int128)x * this->inverse) >> 64);
+            uint64_t result = x - quotient * this->modulus;
+
+            if (result >= this->modulus)
+                result -= this->modulus;
+
+            if (result >= this->modulus)
+                result -= this->modulus;
+
+            return result;
+        }
+    };
+
+    /// @brief Check that modulus is in the supported range
+    /// @param modulus The modulus
+    static void checkModulus(int64_t modulus)
+    {
+        if (modulus < 1 || modulus > SquareMatMod::MAX_MODULUS)
+            throw invalid_argument("Modulus must be between 1 and 2^31 - 1 🫤");
+    }
+
+    /// @brief Check that 2 matrices can be added or multiplied
+    static void checkFit(const SquareMatMod& left, const SquareMatMod& right)
+    {
+        if (left.getSize() != right.getSize())
+            throw invalid_argument("Matrices not in the same size 🫤");
+
+        if (left.getModulus() != right.getModulus())
+            throw invalid_argument("Matrices not in the same modulus 🫤");
+    }
+
+    /// @brief Multiply rows block of A by B, into the same rows of the result, by i-k-j loops
+    /// with the vectorized kernels. Each result row is summed in 64 bits, and reduced once
+    /// after each run of products that can't overflow it
+    /// @param result Cells of the result
+    static void multiplyRows(const SquareMatMod& a, const SquareMatMod& b, int64_t* result, size_t begin, size_t end)
+    {
+        const size_t size = a.getSize();
+        const Kernels& kernels = getKernels();
+        const Barrett barrett{(uint64_t)a.getModulus()};
+
+        // Each product is at most (m - 1)^2, and the sum starts from less than m after each reduction
+        const uint64_t largest = barrett.modulus - 1;
+        const size_t run = largest ? (size_t)min<uint64_t>((UINT64_MAX - largest) / (largest * largest), size) : size;
+
+        if (sums.size() < size)
+            sums.resize(size);
+
+        uint64_t* row = sums.data();
+
+        for (size_t i = begin; i < end; i++)
+        {
+            fill(row, row + size, 0);
+
+            for (size_t k0 = 0; k0 < size; k0 += run)
+            {
+                const size_t k1 = min(size, k0 + run);
+
+                for (size_t k = k0; k < k1; k++)
+                    kernels.multiplyAddIntegers(row, a[i][k], b[k], size);
+
+                // Reduce before the next run, the last run is reduced into the result
+                if (k1 < size)
+                    for (size_t j = 0; j < size; j++)
+                        row[j] = barrett.reduce(row[j]);
+            }
+
+            int64_t* cRow = result + i * size;
+
+            for (size_t j = 0; j < size; j++)
+                cRow[j] = (int64_t)barrett.reduce(row[j]);
+        }
+    }
+
+    SquareMatMod::SquareMatMod(size_t size, int64_t modulus) : size(size), modulus(modulus), cells(size * size, 0)
+    {
+        if (!size)
+            throw invalid_argument("Matrix size must be positive 🫤");
+
+        checkModulus(modulus);
+    }
+
+    SquareMatMod::SquareMatMod(size_t size, int64_t modulus, IdentityTag) : SquareMatMod(size, modulus)
+    {
+        // Modulo 1 every number is 0
+        for (size_t i = 0; i < size; i++)
+            this->cells[i * size + i] = 1 % modulus;
+    }
+
+    SquareMatMod::SquareMatMod(const ConstSquareMatView& mat, int64_t modulus) : SquareMatMod(mat.getSize(), modulus)
+    {
+        for (size_t i = 0; i < this->size; i++)
+            for (size_t j = 0; j < this->size; j++)
+                this->set(i, j, llround(mat[i][j]));
+    }
+
+    SquareMatMod::operator SquareMat() const
+    {
+        SquareMat result{this->size, Uninitialized};
+
+        for (size_t i = 0; i < this->size; i++)
+            for (size_t j = 0; j < this->size; j++)
+                result[i][j] = (double)(*this)[i][j];
+
+        return result;
+    }
+
+    void SquareMatMod::set(size_t row, size_t col, int64_t value)
+    {
+        if (row >= this->size || col >= this->size)
+            throw out_of_range("Cell is out of matrix bounds 🫤");
+
+        value %= this->modulus;
+
+        this->cells[row * this->size + col] = value < 0 ? value + this->modulus : value;
+    }
+
+    SquareMatMod& SquareMatMod::operator+=(const SquareMatMod& other)
+    {
+        checkFit(*this, other);
+
+        // Both cells are less than m, so one subtraction reduces the sum
+        for (size_t cell = 0; cell < this->cells.size(); cell++)
+        {
+            const int64_t sum = this->cells[cell] + other.cells[cell];
+
+            this->cells[cell] = sum >= this->modulus ? sum - this->modulus : sum;
+        }
+
+        return (*this);
+    }
+
+    SquareMatMod& SquareMatMod::operator-=(const SquareMatMod& other)
+    {
+        checkFit(*this, other);
+
+        for (size_t cell = 0; cell < this->cells.size(); cell++)
+        {
+            const int64_t difference = this->cells[cell] - other.cells[cell];
+
+            this->cells[cell] = difference < 0 ? difference + this->modulus : difference;
+        }
+
+        return (*this);
+    }
+
+    SquareMatMod& SquareMatMod::operator*=(const int64_t scalar)
+    {
+        const Barrett barrett{(uint64_t)this->modulus};
+        const int64_t reduced = ((scalar % this->modulus) + this->modulus) % this->modulus;
+
+        for (int64_t& cell : this->cells)
+            cell = barrett.reduce((uint64_t)cell * reduced);
+
+        return (*this);
+    }
+
+    SquareMatMod& SquareMatMod::operator*=(const SquareMatMod& other)
+    {
+        // Calculate into new matrix, because this matrix cells needed until the end
+        SquareMatMod result{this->size, this->modulus};
+
+        multiply(*this, other, result);
+
+        return (*this) = move(result);
+    }
+
+    bool SquareMatMod::operator==(const SquareMatMod& other) const
+    {
+        return this->size == other.size && this->modulus == other.modulus && this->cells == other.cells;
+    }
+
+    SquareMatMod SquareMatMod::operator^(uint64_t exp) const
+    {
+        SquareMatMod result{this->size, this->modulus, Identity};
+        SquareMatMod square{*this};
+        SquareMatMod product{this->size, this->modulus};
+
+        // Multiply back and forth between the matrices, instead of allocate new one each time
+        while (exp)
+        {
+            if (exp & 1)
+            {
+                multiply(result, square, product);
+                std::swap(result, product);
+            }
+
+            exp >>= 1;
+
+            if (exp)
+            {
+                multiply(square, square, product);
+                std::swap(square, product);
+            }
+        }
+
+        return result;
+    }
+
+    void multiply(const SquareMatMod& a, const SquareMatMod& b, SquareMatMod& c, size_t threads)
+    {
+        checkFit(a, b);
+        checkFit(a, c);
+
+        if (&c == &a || &c == &b)
+            throw invalid_argument("Result matrix can't be one of the operands 🫤");
+
+        const size_t size = a.getSize();
+
+        if (size < getParallelThreshold())
+            threads = 1;
+        else if (!threads)
+            threads = getThreadCount();
+
+        int64_t* result = c.cells.data();
+
+        parallelRows(size, threads, [&](size_t begin, size_t end)
+        {
+            multiplyRows(a, b, result, begin, end);
+        });
+    }
+
+    SquareMatMod operator+(SquareMatMod left, const SquareMatMod& right)
+    {
+        // Adds right to left copy, and returns the moved left copy
+        left += right;
+
+        return left;
+    }
+
+    SquareMatMod operator-(SquareMatMod left, const SquareMatMod& right)
+    {
+        // Substructs right from left copy, and returns the moved left copy
+        left -= right;
+
+        return left;
+    }
+
+    SquareMatMod operator*(const SquareMatMod& left, const SquareMatMod& right)
+    {
+        SquareMatMod result{left.getSize(), left.getModulus()};
+
+        multiply(left, right, result);
+
+        return result;
+    }
+
+    SquareMatMod operator*(SquareMatMod mat, const int64_t scalar)
+    {
+        mat *= scalar;
+
+        return mat;
+    }
+
+    SquareMatMod operator*(const int64_t scalar, SquareMatMod mat)
+    {
+        mat *= scalar;
+
+        return mat;
+    }
+
+    ostream& operator<<(ostream& stream, const SquareMatMod& mat)
+    {
+        return stream << SquareMat{mat};
+    }
+}
@@ -0,0 +1,122 @@
+// liorbrown@outlook.co.il
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+#include "SquareMat.hpp"
+
+using namespace std;
+
+namespace Matrix{
+
+    /// @brief This class represents a square matrix of integers modulo m, for exact modular work
+    /// like linear recurrences, instead of multiplying doubles and taking operator% of the result
+    /// (that loses exactness above 2^53). The cells are always reduced to [0, m), and multiplication
+    /// adds exact 64 bit products, reducing by Barrett reduction only when the sum may overflow
+    class SquareMatMod{
+        private:
+
+            size_t size;
+
+            /// @brief The modulus, up to MAX_MODULUS so products of 2 cells fit in 64 bits
+            int64_t modulus;
+
+            /// @brief Cells of the matrix in row-major order, without padding
+            vector<int64_t> cells;
+
+        public:
+
+            /// @brief Biggest modulus, 2^31 - 1
+            static constexpr int64_t MAX_MODULUS = INT32_MAX;
+
+            /// @brief Ctor - creates zero matrix
+            /// @param size The size of the matrix
+            /// @param modulus The modulus, between 1 and MAX_MODULUS
+            SquareMatMod(size_t size, int64_t modulus);
+
+            /// @brief Ctor - creates identity matrix
+            /// @param size The size of the matrix
+            /// @param modulus The modulus, between 1 and MAX_MODULUS
+            SquareMatMod(size_t size, int64_t modulus, IdentityTag);
+
+            /// @brief Ctor - creates matrix with copy of SquareMat (or block) cells,
+            /// each one rounded to integer and reduced modulo the modulus
+            /// @param mat Matrix to copy, its cells must fit in 64 bits integer
+            /// @param modulus The modulus, between 1 and MAX_MODULUS
+            SquareMatMod(const ConstSquareMatView& mat, int64_t modulus);
+
+            /// @brief Convert to SquareMat with copy of the cells, that is exact
+            operator SquareMat() const;
+
+            size_t getSize() const {return this->size;}
+
+            int64_t getModulus() const {return this->modulus;}
+
+            /// @brief Return matrix row, given row index. The cells can't be changed directly,
+            /// because they must stay reduced (see set())
+            /// @param row Index of wanted row
+            /// @return Pointer to the wanted row
+            const int64_t* operator[](size_t row) const {return this->cells.data() + row * this->size;}
+
+            /// @brief Set cell to given value, reduced to [0, modulus)
+            /// @param row Row index of the cell
+            /// @param col Column index of the cell
+            /// @param value The value, may be negative
+            void set(size_t row, size_t col, int64_t value);
+
+            // ---------------- Self assignment operators ----------------------
+
+            SquareMatMod& operator+=(const SquareMatMod& other);
+
+            SquareMatMod& operator-=(const SquareMatMod& other);
+
+            /// @brief Multipy each cell of this matrix by scalar, modulo the modulus
+            SquareMatMod& operator*=(const int64_t scalar);
+
+            /// @brief Multipy this matrix by other matrix, modulo the modulus
+            SquareMatMod& operator*=(const SquareMatMod& other);
+
+            // ---------------- Equality operators ----------------------
+            // Unlike SquareMat, cells are exact, so they compare all the cells
+
+            bool operator==(const SquareMatMod& other) const;
+
+            bool operator!=(const SquareMatMod& other) const {return !(*this == other);}
+
+            /// @brief Return matrix of this matrix power given exponent, by repeated squaring,
+            /// so it takes about 2 * log2(exp) multiplications
+            /// @param exp The exponent
+            /// @return New matrix that represent the result of this matrix power the exponent
+            SquareMatMod operator^(uint64_t exp) const;
+
+            /// @brief Multiplication writes the reduced cells directly
+            friend void multiply(const SquareMatMod& a, const SquareMatMod& b, SquareMatMod& c, size_t threads);
+    };
+
+    /// @brief Multiply 2 modular matrices into third one. Products are summed exactly in 64 bits,
+    /// and reduced only when the next products may overflow the sum (for 2^31 - 1 after each 4 products,
+    /// for small moduli very rarely). Big matrices split their rows between threads (see parallelRows())
+    /// @param a Left operand
+    /// @param b Right operand
+    /// @param c Result, in the same size and modulus, must not be one of the operands
+    /// @param threads Number of threads, 0 means getThreadCount()
+    void multiply(const SquareMatMod& a, const SquareMatMod& b, SquareMatMod& c, size_t threads = 0);
+
+    // ---------------- Out class operators ----------------------
+
+    SquareMatMod operator+(SquareMatMod left, const SquareMatMod& right);
+
+    SquareMatMod operator-(SquareMatMod left, const SquareMatMod& right);
+
+    SquareMatMod operator*(const SquareMatMod& left, const SquareMatMod& right);
+
+    SquareMatMod operator*(SquareMatMod mat, const int64_t scalar);
+
+    SquareMatMod operator*(const int64_t scalar, SquareMatMod mat);
+
+    /// @brief Print the matrix, like SquareMat is printed
+    ostream& operator<<(ostream& stream, const SquareMatMod& mat);
+}
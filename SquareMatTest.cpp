@@ -4,6 +4,18 @@
 
 #include "doctest.hpp"
 #include "SquareMat.hpp"
+#include "MatArena.hpp"
+#include "MatPool.hpp"
+#include "MatPages.hpp"
+#include "Parallel.hpp"
+#include "MatGemm.hpp"
+#include "MatKernels.hpp"
+#include "MatStrassen.hpp"
+#include "SquareMatBatch.hpp"
+#include "FixedSquareMat.hpp"
+#include "MatBlas.hpp"
+#include "SquareMatF.hpp"
+#include "SquareMatMod.hpp"
 
 #define DEFAULT_SIZE (3)
 #define EPS (0.0001)
@@ -43,6 +55,41 @@ bool isEqual(const SquareMat& mat1, const SquareMat& mat2)
     return true;
 }
 
+/// @brief Check if 2 blocks have exactly the same cells
+/// @param mat1 First block to compare
+/// @param mat2 Seconed block to compare
+/// @return True - if all cells are the same, False - otherwise
+bool isIdentical(const ConstSquareMatView& mat1, const ConstSquareMatView& mat2)
+{
+    if (mat1.getSize() != mat2.getSize())
+        return false;
+
+    for (size_t i = 0; i < mat1.getSize(); i++)
+        for (size_t j = 0; j < mat1.getSize(); j++)
+            if (mat1[i][j] != mat2[i][j])
+                return false;
+
+    return true;
+}
+
+/// @brief Fill operands of multiplication with small integers and quarters,
+/// so all their products and sums are exact in double
+/// @param left Left operand to fill
+/// @param right Right operand to fill, in the same size
+void fillOperands(const SquareMatView& left, const SquareMatView& right)
+{
+    for (size_t i = 0; i < left.getSize(); i++)
+        for (size_t j = 0; j < left.getSize(); j++)
+        {
+            left[i][j] = (double)((i * 7 + j * 3) % 11) - 5;
+            right[i][j] = (double)((i * 5 + j) % 13) / 4;
+        }
+}
+
+/// @brief Whether cells can be changed through given view type
+template <typename View>
+concept WritableView = requires(View view) {view *= 5.0;};
+
 TEST_CASE("Creating matrix")
 {
     // Ensure canwt create matrix in size of 0
@@ -110,6 +157,1392 @@ TEST_CASE("Copy constructor and assignment operator")
     CHECK (isEqual(matAssignment, *globalMat1));
 }
 
+TEST_CASE("Move constructor, move assignment and swap")
+{
+    SquareMat source{*globalMat1};
+
+    // Check move constructor copies inline matrix, and leaves source empty
+    SquareMat moved{std::move(source)};
+
+    CHECK(isEqual(*globalMat1, moved));
+    CHECK(source.getSize() == 0);
+
+    // Check move assignment between matrices in different sizes
+    SquareMat assigned{8};
+    assigned = std::move(moved);
+
+    CHECK(isEqual(*globalMat1, assigned));
+
+    // Check moved from matrix can be assigned again
+    source = *globalMat2;
+
+    CHECK(isEqual(*globalMat2, source));
+
+    // Check swap exchange content of inline matrices
+    swap(source, assigned);
+
+    CHECK(isEqual(*globalMat1, source));
+    CHECK(isEqual(*globalMat2, assigned));
+
+    // Check that big matrices pass their memory along, without copying it
+    SquareMat bigSource{16};
+    bigSource[15][15] = 4.5;
+    const double* cells = bigSource[0];
+
+    SquareMat bigMoved{std::move(bigSource)};
+
+    CHECK(bigMoved[0] == cells);
+    CHECK(bigMoved[15][15] == 4.5);
+
+    SquareMat bigAssigned{20};
+    bigAssigned = std::move(bigMoved);
+
+    CHECK(bigAssigned[0] == cells);
+
+    // Check swap between heap matrix and inline matrix
+    swap(bigAssigned, source);
+
+    CHECK(source[0] == cells);
+    CHECK(source[15][15] == 4.5);
+    CHECK(isEqual(*globalMat1, bigAssigned));
+}
+
+TEST_CASE("Inline storage for small matrices")
+{
+    // Check that small matrix cells are inside the matrix object itself
+    SquareMat small{SquareMat::INLINE_SIZE};
+    const char* object = reinterpret_cast<const char*>(&small);
+    const char* cells = reinterpret_cast<const char*>(small[0]);
+
+    CHECK((cells >= object && cells < object + sizeof(SquareMat)));
+
+    // Check that bigger matrix cells are outside the object
+    SquareMat big{SquareMat::INLINE_SIZE + 1};
+    object = reinterpret_cast<const char*>(&big);
+    cells = reinterpret_cast<const char*>(big[0]);
+
+    CHECK_FALSE((cells >= object && cells < object + sizeof(SquareMat)));
+
+    // Check that the object is only the inline cells and one cache line for the other fields,
+    // and that views never carry the inline cells
+    CHECK(sizeof(SquareMat) == SquareMat::INLINE_SIZE * SquareMat::INLINE_SIZE * sizeof(double) + SquareMat::ALIGNMENT);
+    CHECK(sizeof(SquareMatView) < SquareMat::ALIGNMENT);
+
+    // Check assignment between inline and heap matrices
+    big = *globalMat1;
+
+    CHECK(isEqual(*globalMat1, big));
+
+    small = SquareMat{SquareMat::INLINE_SIZE + 5};
+    small[12][12] = 3;
+
+    CHECK(small.getSize() == SquareMat::INLINE_SIZE + 5);
+    CHECK(small[12][12] == 3);
+}
+
+TEST_CASE("Arena memory")
+{
+    // Ensure can't create arena with no memory
+    CHECK_THROWS_AS(MatArena{0}, invalid_argument);
+
+    MatArena arena{1 << 16};
+
+    CHECK(MatArena::getActive() == nullptr);
+
+    {
+        ArenaScope scope{arena};
+
+        CHECK(MatArena::getActive() == &arena);
+
+        // Check that heap matrices draw memory from active arena, and inline not
+        SquareMat big{20};
+        SquareMat small{*globalMat1};
+
+        CHECK(arena.getLiveBlocks() == 1);
+        CHECK(big.getAlignment() == SquareMat::ALIGNMENT);
+
+        // Check that temporaries of operators also draw from arena,
+        // and release it when destroyed
+        big[3][4] = 2;
+        SquareMat product = big * big + big;
+
+        CHECK(product[3][4] == 2);
+        CHECK(arena.getLiveBlocks() == 2);
+
+        // Ensure arena can't be reset while matrices use it
+        CHECK_THROWS_AS(arena.reset(), logic_error);
+
+        // Check that allocation bigger than arena chunk still works
+        SquareMat huge{100};
+        huge[99][99] = 1;
+
+        CHECK(arena.getCapacity() > (1 << 16));
+    }
+
+    // Check that scope restores no active arena, and all blocks released
+    CHECK(MatArena::getActive() == nullptr);
+    CHECK(arena.getLiveBlocks() == 0);
+    CHECK_NOTHROW(arena.reset());
+
+    SquareMat heapMat{20};
+
+    CHECK(arena.getLiveBlocks() == 0);
+}
+
+TEST_CASE("Pool memory")
+{
+    MatPool* pool = MatPool::local();
+
+    // Check that pool is disabled by default
+    REQUIRE(pool != nullptr);
+    CHECK_FALSE(pool->isEnabled());
+
+    pool->setEnabled(true);
+    pool->resetStats();
+
+    // Check that first matrix miss, and freed memory kept in pool
+    const double* cells;
+    {
+        SquareMat mat{20};
+        cells = mat[0];
+    }
+
+    CHECK(pool->getMisses() == 1);
+    CHECK(pool->getCachedBytes() > 0);
+
+    // Check that next matrix in same size reuse the memory, and it zero again
+    {
+        SquareMat mat{20};
+
+        CHECK(mat[0] == cells);
+        CHECK(pool->getHits() == 1);
+        CHECK(isEqual(mat, SquareMat{20}));
+
+        mat[5][5] = 7;
+    }
+
+    // Check that other size not use the same bucket
+    SquareMat other{30};
+
+    CHECK(other[0] != cells);
+    CHECK(pool->getMisses() == 3);
+
+    // Check that limits free the kept blocks above them
+    pool->setLimits(0, MatPool::DEFAULT_MAX_BYTES);
+
+    CHECK(pool->getCachedBytes() == 0);
+
+    pool->setLimits(MatPool::DEFAULT_MAX_BLOCKS, MatPool::DEFAULT_MAX_BYTES);
+    pool->setEnabled(false);
+}
+
+TEST_CASE("File backed matrix")
+{
+    const string path = "/tmp/SquareMatTest.mat";
+    remove(path.c_str());
+
+    // Ensure can't map missing file in read only mode
+    CHECK_THROWS_AS(SquareMat(path, DEFAULT_SIZE, SquareMat::MapMode::ReadOnly), system_error);
+
+    {
+        // Check that new file is created with zero cells
+        SquareMat mat{path, DEFAULT_SIZE, SquareMat::MapMode::ReadWrite};
+
+        CHECK(mat.isMapped());
+        CHECK(isEqual(*zeroMat, mat));
+
+        // Check that move assignment in same size keeps the file
+        mat = *globalMat1 * *globalMat2;
+
+        CHECK(mat.isMapped());
+        mat.flush();
+    }
+
+    {
+        // Check that result persisted in the file
+        SquareMat mat{path, DEFAULT_SIZE, SquareMat::MapMode::ReadOnly};
+
+        CHECK(isEqual(*globalMat1 * *globalMat2, mat));
+
+        // Check that writes to read only matrix not change the file
+        mat[0][0] = 1234;
+    }
+
+    SquareMat mat{path, DEFAULT_SIZE, SquareMat::MapMode::ReadOnly};
+
+    CHECK(isEqual(*globalMat1 * *globalMat2, mat));
+
+    // Ensure file in other size can't be mapped
+    CHECK_THROWS_AS(SquareMat(path, DEFAULT_SIZE + 1, SquareMat::MapMode::ReadOnly), invalid_argument);
+
+    // Check that copy of file backed matrix is a regular matrix
+    SquareMat copy{mat};
+
+    CHECK_FALSE(copy.isMapped());
+    CHECK(isEqual(copy, mat));
+
+    {
+        // Check that multiplication writes into the file, instead of taking the mapping away
+        SquareMat mapped{path, DEFAULT_SIZE, SquareMat::MapMode::ReadWrite};
+        SquareMat other{*globalMat2};
+
+        mapped *= *globalMat1;
+        CHECK(mapped.isMapped());
+
+        mapped *= transposed(*globalMat1);
+        CHECK(mapped.isMapped());
+
+        // Check that swap only exchanges the memories, so the mapping goes with them
+        static_assert(noexcept(swap(mapped, other)));
+        swap(mapped, other);
+
+        CHECK(other.isMapped());
+        CHECK_FALSE(mapped.isMapped());
+        CHECK(isEqual(mapped, *globalMat2));
+
+        swap(mapped, other);
+
+        // Check that move assignment in other size detaches the matrix from the file,
+        // and the file keeps its last cells
+        mapped = SquareMat{DEFAULT_SIZE + 1, Fill, 1.0};
+
+        CHECK_FALSE(mapped.isMapped());
+        CHECK(mapped.getSize() == DEFAULT_SIZE + 1);
+        CHECK(mapped[DEFAULT_SIZE][DEFAULT_SIZE] == 1);
+    }
+
+    {
+        SquareMat reopened{path, DEFAULT_SIZE, SquareMat::MapMode::ReadOnly};
+
+        CHECK(isEqual(reopened, copy * *globalMat1 * ~*globalMat1));
+    }
+
+    remove(path.c_str());
+}
+
+TEST_CASE("Block views")
+{
+    // Place globalMat1 in the bottom right block of bigger matrix
+    SquareMat big{5};
+
+    for (size_t i = 0; i < DEFAULT_SIZE; i++)
+        for (size_t j = 0; j < DEFAULT_SIZE; j++)
+            big[i + 2][j + 2] = (*globalMat1)[i][j];
+
+    SquareMatView view = big.block(2, 2, DEFAULT_SIZE);
+
+    // Check view points to the matrix cells, without copying them
+    CHECK(view.getSize() == DEFAULT_SIZE);
+    CHECK(view.getStride() == big.getStride());
+    CHECK(view[0] == &big[2][2]);
+
+    // Ensure blocks out of bounds can't be created
+    CHECK_THROWS_AS(big.block(3, 0, DEFAULT_SIZE), invalid_argument);
+    CHECK_THROWS_AS(view.block(1, 1, DEFAULT_SIZE), invalid_argument);
+    CHECK_THROWS_AS(SquareMatView(big[0], 3, 2), invalid_argument);
+
+    // Check that operators accept views like matrices
+    CHECK(isEqual(*globalMat1 + *globalMat2, *globalMat2 + view));
+    CHECK(isEqual(*globalMat1 * *globalMat2, SquareMat{view} * *globalMat2));
+    CHECK(isEqual(*globalMat2 * *globalMat1, *globalMat2 * view));
+    CHECK(isEqual(*globalMat2 - *globalMat1, *globalMat2 - view));
+    CHECK(isEqual(*globalMat2 % *globalMat1, *globalMat2 % view));
+    CHECK_THROWS_AS(*globalMat2 + big.block(0, 0, 2), invalid_argument);
+
+    // Check determinant of block, and that it not change the block
+    CHECK(isEqual(97.6, !view));
+    CHECK(isEqual(*globalMat1, SquareMat{view}));
+
+    // Check that operators on view change the viewed matrix only inside the block
+    view += *globalMat2;
+    view *= 2;
+
+    CHECK(isEqual((*globalMat1 + *globalMat2) * 2, SquareMat{view}));
+    CHECK(big[0][0] == 0);
+    CHECK(big[1][4] == 0);
+    CHECK(big[4][1] == 0);
+}
+
+TEST_CASE("Copy-on-write mode")
+{
+    // Check that inline matrices can't share their memory
+    SquareMat small{*globalMat1};
+
+    CHECK_FALSE(small.enableCopyOnWrite());
+
+    SquareMat original{20};
+    original[3][4] = 5;
+
+    CHECK(original.enableCopyOnWrite());
+    CHECK_FALSE(original.isShared());
+
+    // Check that copies share the memory, and are also in copy-on-write mode
+    const SquareMat copy{original};
+    SquareMat assigned{20};
+    assigned = original;
+
+    CHECK(copy[0] == std::as_const(original)[0]);
+    CHECK(std::as_const(assigned)[0] == std::as_const(original)[0]);
+    CHECK(original.isShared());
+    CHECK(assigned.isCopyOnWrite());
+
+    // Check that reading operators not detach the copies
+    SquareMat sum = copy + assigned;
+
+    CHECK(sum[3][4] == 10);
+    CHECK(copy[0] == std::as_const(original)[0]);
+
+    // Check that first change gives the changed matrix its own memory,
+    // and other copies not see the change
+    assigned += sum;
+
+    CHECK(std::as_const(assigned)[0] != copy[0]);
+    CHECK(assigned[3][4] == 15);
+    CHECK(copy[3][4] == 5);
+    CHECK(assigned.isCopyOnWrite());
+    CHECK_FALSE(assigned.isShared());
+
+    // Check that non const [] also detach
+    original[3][4] = 7;
+
+    CHECK(copy[3][4] == 5);
+    CHECK_FALSE(copy.isShared());
+
+    // Check that matrix multiplication keeps the mode, and not change the copies
+    SquareMat product{original};
+    product *= sum;
+
+    CHECK(product.isCopyOnWrite());
+    CHECK(original[3][4] == 7);
+    CHECK(product[3][4] == 0);
+
+    // Check that const matrix gives only read only views, so they can't change shared memory
+    const SquareMat shared{original};
+
+    static_assert(!WritableView<decltype(shared.block(0, 0, 4))>);
+    static_assert(!WritableView<ConstSquareMatView>);
+    static_assert(WritableView<SquareMatView>);
+    static_assert(!is_constructible_v<SquareMatView, const SquareMat&>);
+
+    CHECK(shared.block(0, 0, 4).getSum() == ConstSquareMatView{original}.block(0, 0, 4).getSum());
+    CHECK(shared[0] == std::as_const(original)[0]);
+
+    // Check that writable view of shared copy detaches it first
+    SquareMat viewed{original};
+
+    SquareMatView{viewed} += SquareMatView{viewed};
+
+    CHECK(viewed[3][4] == 14);
+    CHECK(original[3][4] == 7);
+    CHECK(shared[3][4] == 7);
+
+    viewed = original;
+    viewed.block(3, 3, 2) *= 5;
+
+    CHECK(viewed[3][4] == 35);
+    CHECK(original[3][4] == 7);
+}
+
+TEST_CASE("Huge pages")
+{
+    CHECK(SquareMat::getHugePageThreshold() == SquareMat::DEFAULT_HUGE_PAGE_THRESHOLD);
+
+    // Lower the threshold, so matrix of few MB is backed by huge pages
+    SquareMat::setHugePageThreshold(SquareMat::HUGE_PAGE);
+
+    SquareMat big{512};
+
+    CHECK((uintptr_t)big[0] % SquareMat::HUGE_PAGE == 0);
+    CHECK(big.getAlignment() == SquareMat::ALIGNMENT);
+
+    // Touch all cells, so the kernel gives the pages
+    big += big;
+    ++big;
+
+    CHECK(big[511][511] == 1);
+    CHECK(big.getHugePageBytes() <= hugePagesLength(512 * big.getStride() * sizeof(double)));
+
+    // When the kernel has huge pages to give (reserved or transparent), the touched matrix must get them
+    if (freeReservedBytes() >= SquareMat::HUGE_PAGE || transparentHugePagesEnabled())
+        CHECK(big.getHugePageBytes() > 0);
+    else
+        MESSAGE("Kernel has no huge pages, so only the alignment is checked");
+
+    // Check that moved matrix keeps its huge pages, and copy gets its own
+    SquareMat moved{std::move(big)};
+    SquareMat copy{moved};
+
+    CHECK(isEqual(moved, copy));
+    CHECK((uintptr_t)copy[0] % SquareMat::HUGE_PAGE == 0);
+
+    // Check that small matrices and matrices under threshold not use huge pages
+    SquareMat::setHugePageThreshold(SIZE_MAX);
+
+    SquareMat regular{512};
+
+    CHECK(regular.getHugePageBytes() == 0);
+    CHECK(globalMat1->getHugePageBytes() == 0);
+
+    SquareMat::setHugePageThreshold(SquareMat::DEFAULT_HUGE_PAGE_THRESHOLD);
+}
+
+TEST_CASE("NUMA placement")
+{
+    CHECK(SquareMat::getPlacement() == SquareMat::Placement::Local);
+
+    // Check that rows blocks cover all rows once, also with more threads than rows
+    vector<size_t> touched(10, 0);
+
+    parallelRows(10, 4, [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; i++)
+            touched[i]++;
+    });
+
+    CHECK(touched == vector<size_t>(10, 1));
+
+    parallelRows(3, 8, [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; i++)
+            touched[i]++;
+    });
+
+    CHECK(touched[2] == 2);
+    CHECK(touched[3] == 1);
+
+    setThreadCount(3);
+    CHECK(getThreadCount() == 3);
+
+    // Check that placed matrices start with zero, and that zeroing put all their pages on nodes:
+    // on one node system all of them on node 0, and interleaved ones over more than one node
+    for (SquareMat::Placement placement : {SquareMat::Placement::FirstTouch, SquareMat::Placement::Interleave})
+    {
+        SquareMat::setPlacement(placement);
+
+        SquareMat big{512};
+        const size_t total = 512 * big.getStride() * sizeof(double);
+        const vector<size_t> nodes = big.getNodeBytes();
+        size_t placed = 0, used = 0;
+
+        CHECK(isEqual(big, SquareMat{512}));
+        CHECK(big.getAlignment() == SquareMat::ALIGNMENT);
+
+        for (size_t bytes : nodes)
+        {
+            placed += bytes;
+            used += bytes > 0;
+        }
+
+        CAPTURE(nodes.size());
+        CHECK(placed == total);
+
+        if (numaNodeCount() == 1)
+            CHECK(nodes[0] == total);
+        else if (placement == SquareMat::Placement::Interleave)
+            CHECK(used > 1);
+
+        ++big;
+        SquareMat copy{big};
+
+        CHECK(isEqual(big, copy));
+        CHECK(copy[511][511] == 1);
+    }
+
+    SquareMat::setPlacement(SquareMat::Placement::Local);
+    setThreadCount(0);
+
+    CHECK(getThreadCount() >= 1);
+}
+
+TEST_CASE("Construction modes")
+{
+    SquareMat filled{20, Fill, 2.5};
+    SquareMat identity{20, Identity};
+
+    CHECK(filled[0][0] == 2.5);
+    CHECK(filled[19][19] == 2.5);
+    CHECK(isEqual(identity * filled, filled));
+    CHECK(isEqual(SquareMat{DEFAULT_SIZE, Identity}, *identityMat));
+
+    // Check that padding stays zero, so whole rows can be summerized
+    CHECK(filled[0][filled.getStride() - 1] == 0);
+
+    vector<double> cells{4.5, 8.0, 7.0, 2.0, 0.0, -12.0, 3.3, 5.6, -2.1};
+    SquareMat copied{3, cells};
+
+    CHECK(isEqual(copied, *globalMat1));
+    CHECK_THROWS(SquareMat{4, cells});
+
+    // Check that uninitialized matrix is usable after writing all its cells
+    SquareMat uninitialized{20, Uninitialized};
+    uninitialized = filled;
+
+    CHECK(isEqual(uninitialized, filled));
+    CHECK_THROWS(SquareMat{0, Uninitialized});
+    CHECK_THROWS(SquareMat{0, Identity});
+
+    // Check that copy of block is exact, and its padding is zero
+    SquareMat block{filled.block(2, 3, 10)};
+
+    CHECK(block.getSize() == 10);
+    CHECK(block[9][9] == 2.5);
+    CHECK(block[0][block.getStride() - 1] == 0);
+}
+
+TEST_CASE("Blocked multiplication")
+{
+    // Sizes on both sides of the small matrices limit, and over the kernel blocks edges
+    for (size_t size : {GEMM_SMALL, GEMM_SMALL + 1, GEMM_MC + 3, GEMM_KC + 45})
+    {
+        SquareMat left{size, Uninitialized};
+        SquareMat right{size, Uninitialized};
+
+        fillOperands(left, right);
+
+        SquareMat product = left * right;
+
+        // Compare with plain triple loop, all values are exact in double
+        bool equal = true;
+
+        for (size_t i = 0; i < size; i++)
+            for (size_t j = 0; j < size; j++)
+            {
+                double cell = 0;
+
+                for (size_t k = 0; k < size; k++)
+                    cell += left[i][k] * right[k][j];
+
+                equal &= (cell == product[i][j]);
+            }
+
+        CHECK(equal);
+
+        if (product.getStride() > size)
+            CHECK(product[size - 1][product.getStride() - 1] == 0);
+    }
+
+    // Check product of blocks, that their rows stride is bigger than their size
+    SquareMat big{GEMM_MC + 3, Fill, 1.0};
+    SquareMat product = SquareMat{big.block(1, 2, 40)} * big.block(0, 0, 40);
+
+    CHECK(product[39][39] == 40);
+}
+
+TEST_CASE("Vectorized kernels")
+{
+    const KernelLevel original = getKernels().level;
+    const size_t size = 37;
+
+    SquareMat left{size, Uninitialized};
+    SquareMat right{size, Uninitialized};
+
+    // Right cells are positive, so they can divide
+    fillOperands(left, right);
+    ++right;
+
+    // Results of the plain loops, all values are exact in double
+    SquareMat sum{size}, difference{size}, elements{size}, scaled{size}, divided{size}, product{size};
+    double total = 0;
+
+    for (size_t i = 0; i < size; i++)
+        for (size_t j = 0; j < size; j++)
+        {
+            sum[i][j] = left[i][j] + right[i][j];
+            difference[i][j] = left[i][j] - right[i][j];
+            elements[i][j] = left[i][j] * right[i][j];
+            scaled[i][j] = left[i][j] * 0.5;
+            divided[i][j] = left[i][j] / 4;
+            total += left[i][j];
+
+            for (size_t k = 0; k < size; k++)
+                product[i][j] += left[i][k] * right[k][j];
+        }
+
+    // Equality operators compare only sums, so this matrix has the same sum
+    SquareMat sameSum{size};
+    sameSum[0][0] = total;
+
+    CHECK(isKernelSupported(KernelLevel::Generic));
+
+    // Check that every supported variant gives the same results
+    for (KernelLevel level : {KernelLevel::Generic, KernelLevel::Sse2, KernelLevel::Avx2, KernelLevel::Avx512})
+    {
+        if (!isKernelSupported(level))
+        {
+            CHECK_THROWS(setKernelLevel(level));
+            continue;
+        }
+
+        setKernelLevel(level);
+        CAPTURE(getKernels().name);
+
+        CHECK(isEqual(left + right, sum));
+        CHECK(isEqual(left - right, difference));
+        CHECK(isEqual(left % right, elements));
+        CHECK(isEqual(left * 0.5, scaled));
+        CHECK(isEqual(left / 4, divided));
+        CHECK(isEqual(left * right, product));
+        CHECK(left == sameSum);
+
+        // Check block with odd offset and size, so no row starts on vector boundary
+        SquareMat copy{left};
+        copy.block(1, 3, 30) += right.block(2, 1, 30);
+
+        CHECK(copy[1][3] == left[1][3] + right[2][1]);
+        CHECK(copy[30][32] == left[30][32] + right[31][30]);
+        CHECK(copy[0][0] == left[0][0]);
+        CHECK(copy[31][33] == left[31][33]);
+    }
+
+    setKernelLevel(original);
+}
+
+TEST_CASE("Multithreaded multiplication")
+{
+    const size_t size = GEMM_KC + 45;
+
+    SquareMat left{size, Uninitialized};
+    SquareMat right{size, Uninitialized};
+
+    for (size_t i = 0; i < size; i++)
+        for (size_t j = 0; j < size; j++)
+        {
+            left[i][j] = sin(i * 0.37 + j);
+            right[i][j] = cos(i + j * 0.11);
+        }
+
+    SquareMat serial{size, Uninitialized};
+    multiply(left, right, serial, 1);
+
+    // Check that any number of threads gives exactly the same cells
+    for (size_t threads : {2, 3, 7})
+    {
+        SquareMat parallel{size, Uninitialized};
+        multiply(left, right, parallel, threads);
+
+        CAPTURE(threads);
+        CHECK(isIdentical(serial, parallel));
+    }
+
+    // Check that also adding to old result (nonzero beta) is the same in any number of threads,
+    // with all the kernels, even if rows split puts other rows on the edge micro blocks
+    const KernelLevel original = getKernels().level;
+
+    for (KernelLevel level : {KernelLevel::Generic, KernelLevel::Sse2, KernelLevel::Avx2, KernelLevel::Avx512})
+    {
+        if (!isKernelSupported(level))
+            continue;
+
+        setKernelLevel(level);
+        setThreadCount(1);
+
+        SquareMat fused{right};
+        gemm(0.5, left, right, 0.3, fused);
+
+        for (size_t threads : {2, 3, 7})
+        {
+            setThreadCount(threads);
+
+            SquareMat parallel{right};
+            gemm(0.5, left, right, 0.3, parallel);
+
+            CAPTURE(string{getKernels().name});
+            CAPTURE(threads);
+            CHECK(isIdentical(fused, parallel));
+        }
+    }
+
+    setKernelLevel(original);
+
+    // Check the operator with global thread count, and matrices under threshold
+    setThreadCount(4);
+    CHECK(getParallelThreshold() == DEFAULT_PARALLEL_THRESHOLD);
+
+    SquareMat product = left * right;
+
+    CHECK(product[0][0] == serial[0][0]);
+    CHECK(product[size - 1][size - 1] == serial[size - 1][size - 1]);
+
+    setParallelThreshold(SIZE_MAX);
+    product = left * right;
+
+    CHECK(product[size / 2][size / 3] == serial[size / 2][size / 3]);
+
+    setParallelThreshold(DEFAULT_PARALLEL_THRESHOLD);
+    setThreadCount(0);
+
+    // Check that parallel work inside parallel work not waits forever
+    atomic<size_t> rows{0};
+
+    parallelRows(4, 4, [&](size_t begin, size_t end)
+    {
+        parallelRows(10 * (end - begin), 3, [&](size_t innerBegin, size_t innerEnd)
+        {
+            rows += innerEnd - innerBegin;
+        });
+    });
+
+    CHECK(rows == 40);
+
+    // Check that exception of any block reaches the caller only after all blocks are done,
+    // both when the calling thread throws and when only workers throw
+    for (size_t failing : {0, 5})
+    {
+        rows = 0;
+
+        CHECK_THROWS_AS(parallelRows(8, 4, [&](size_t begin, size_t end)
+        {
+            if (begin <= failing && failing < end)
+                throw runtime_error("Failed block");
+
+            rows += end - begin;
+        }), runtime_error);
+
+        CAPTURE(failing);
+        CHECK(rows == 6);
+    }
+
+    // And that the pool still works after it
+    rows = 0;
+    parallelRows(8, 4, [&](size_t begin, size_t end) {rows += end - begin;});
+
+    CHECK(rows == 8);
+}
+
+TEST_CASE("Strassen multiplication")
+{
+    // Odd size, that padded in 3 levels down to the crossover
+    const size_t size = 101;
+
+    SquareMat left{size, Uninitialized};
+    SquareMat right{size, Uninitialized};
+
+    fillOperands(left, right);
+
+    SquareMat blocked{size, Uninitialized};
+    SquareMat strassen{size, Uninitialized};
+
+    multiply(left, right, blocked);
+    multiplyStrassen(left, right, strassen, 16);
+
+    // Small integers and quarters stay exact in all the additions
+    CHECK(isIdentical(blocked, strassen));
+
+    // Check size that splits evenly, and block operands
+    SquareMat block{left.block(3, 5, 64)};
+    multiplyStrassen(left.block(3, 5, 64), right.block(0, 0, 64), strassen.block(0, 0, 64), 32);
+
+    CHECK(isEqual(SquareMat{strassen.block(0, 0, 64)}, block * right.block(0, 0, 64)));
+
+    // Check the operator policy
+    CHECK(getMultiplyPolicy() == MultiplyPolicy::Blocked);
+    CHECK(getStrassenCrossover() == DEFAULT_STRASSEN_CROSSOVER);
+    CHECK_THROWS(setStrassenCrossover(0));
+
+    setMultiplyPolicy(MultiplyPolicy::Strassen);
+    setStrassenCrossover(40);
+
+    CHECK(isEqual(left * right, blocked));
+
+    setMultiplyPolicy(MultiplyPolicy::Blocked);
+    setStrassenCrossover(DEFAULT_STRASSEN_CROSSOVER);
+}
+
+TEST_CASE("Fused multiplication")
+{
+    // Small size that uses plain loops, and size that uses the blocked kernel
+    for (size_t size : {(size_t)5, GEMM_MC + 3})
+    {
+        SquareMat left{size, Uninitialized};
+        SquareMat right{size, Uninitialized};
+        SquareMat result{size, Uninitialized};
+
+        fillOperands(left, right);
+
+        for (size_t i = 0; i < size; i++)
+            for (size_t j = 0; j < size; j++)
+                result[i][j] = (double)(i + 2 * j);
+
+        for (bool transA : {false, true})
+            for (bool transB : {false, true})
+            {
+                SquareMat expected = (transA ? ~left : left) * (transB ? ~right : right) * 2.0 + result * 0.5;
+                SquareMat fused{result};
+
+                gemm(2.0, left, right, 0.5, fused, transA, transB);
+
+                CAPTURE(size);
+                CAPTURE(transA);
+                CAPTURE(transB);
+                CHECK(isEqual(fused, expected));
+            }
+
+        // Check that zero beta not reads the result, even if it is not a number
+        SquareMat product{size, Fill, NAN};
+        gemm(1.0, left, right, 0.0, product);
+
+        CHECK(isEqual(product, left * right));
+    }
+
+    SquareMat mat{3};
+    CHECK_THROWS(gemm(1.0, *globalMat1, SquareMat{4}, 0.0, mat));
+
+    // Check that result that overlaps an operand is rejected, even by one cell
+    SquareMat big{2 * GEMM_SMALL + 2};
+
+    for (size_t i = 0; i < big.getSize(); i++)
+        big[i][i] = 1;
+
+    CHECK_THROWS_AS(gemm(1.0, mat, *globalMat2, 1.0, mat), invalid_argument);
+    CHECK_THROWS_AS(multiply(*globalMat1, mat, mat), invalid_argument);
+    CHECK_THROWS_AS(multiply(big.block(0, 0, 30), big.block(20, 20, 30), big.block(29, 0, 30)), invalid_argument);
+    CHECK_THROWS_AS(multiply(big.block(0, 0, 30), big.block(20, 20, 30), big.block(0, 29, 30)), invalid_argument);
+    CHECK_THROWS_AS(multiply(big.block(1, 30, 20), big.block(0, 0, 20), big.block(20, 11, 20)), invalid_argument);
+
+    // And that blocks of the same matrix that not share cells are fine
+    multiply(big.block(0, 0, 33), big.block(0, 0, 33), big.block(0, 33, 33));
+    multiply(big.block(0, 33, 33), big.block(33, 33, 33), big.block(33, 0, 33));
+
+    CHECK(big[0][33] == 1);
+    CHECK(big[33][0] == 1);
+    CHECK(big[1][33] == 0);
+}
+
+TEST_CASE("Multiply by transpose")
+{
+    for (size_t size : {(size_t)DEFAULT_SIZE, GEMM_MC + 3})
+    {
+        SquareMat left{size, Uninitialized};
+        SquareMat right{size, Uninitialized};
+
+        fillOperands(left, right);
+
+        CAPTURE(size);
+        CHECK(isEqual(left * transposed(right), left * ~right));
+        CHECK(isEqual(transposed(left) * right, ~left * right));
+        CHECK(isEqual(transposed(left) * transposed(right), ~left * ~right));
+
+        SquareMat product{left};
+        product *= transposed(right);
+
+        CHECK(isEqual(product, left * ~right));
+    }
+
+    // Check transpose of block
+    SquareMat big{*globalMat1 * 2.0};
+    SquareMat product = globalMat1->block(0, 0, 2) * transposed(big.block(1, 1, 2));
+
+    CHECK(isEqual(product[0][1], (*globalMat1)[0][0] * big[2][1] + (*globalMat1)[0][1] * big[2][2]));
+    CHECK_THROWS(*globalMat1 * transposed(SquareMat{4}));
+}
+
+TEST_CASE("Packed operand")
+{
+    // Small, blocked, and more than one depth panel
+    for (size_t size : {(size_t)DEFAULT_SIZE, GEMM_MC + 3, GEMM_KC + 5})
+    {
+        SquareMat left{size, Uninitialized};
+        SquareMat right{size, Uninitialized};
+
+        fillOperands(left, right);
+
+        const PackedOperand packed{right};
+        const PackedOperand packedTranspose{right, true};
+
+        SquareMat product{size, Uninitialized};
+        SquareMat expected{size, Uninitialized};
+
+        CAPTURE(size);
+        CHECK(packed.getSize() == size);
+
+        // Packed operand is multiplied exactly like the one that packed on the fly
+        multiply(left, packed, product);
+        multiply(left, right, expected);
+
+        CHECK(isIdentical(product, expected));
+
+        gemm(2.0, left, packedTranspose, 1.0, product, true);
+        gemm(2.0, left, right, 1.0, expected, true, true);
+
+        CHECK(isIdentical(product, expected));
+
+        // Packed cells are a copy, so changing the source not changes them
+        expected = left * right;
+        right[0][0] += 1;
+        multiply(left, packed, product);
+
+        CHECK(isEqual(product, expected));
+    }
+
+    SquareMat unfit{DEFAULT_SIZE};
+
+    CHECK_THROWS(multiply(*globalMat1, PackedOperand{SquareMat{4}}, unfit));
+
+    // Power packs the matrix once, and must give the same as multiplying again and again
+    SquareMat base{GEMM_MC + 3, Uninitialized};
+
+    for (size_t i = 0; i < base.getSize(); i++)
+        for (size_t j = 0; j < base.getSize(); j++)
+            base[i][j] = (double)((i * 3 + j * 5) % 7) / 16;
+
+    SquareMat repeated{base.getSize(), Identity};
+
+    for (size_t i = 0; i < 4; i++)
+        repeated *= base;
+
+    CHECK(isEqual(base ^ 4, repeated));
+    CHECK(isEqual(base ^ 0, SquareMat{base.getSize(), Identity}));
+}
+
+TEST_CASE("BLAS backend")
+{
+    const Backend backend = getBackend();
+
+    if (!isBlasAvailable())
+    {
+        CHECK(backend == Backend::Builtin);
+        CHECK(string{getBackendName()} == "builtin");
+        CHECK_THROWS(setBackend(Backend::Blas));
+
+        return;
+    }
+
+    // BLAS results must agree with the built-in kernels, also on blocks and transposes
+    for (size_t size : {(size_t)DEFAULT_SIZE, GEMM_MC + 3})
+    {
+        SquareMat left{size + 1, Uninitialized};
+        SquareMat right{size, Uninitialized};
+
+        const SquareMatView block = left.block(1, 1, size);
+
+        fillOperands(block, right);
+        SquareMat blas{right};
+        SquareMat builtin{right};
+
+        CAPTURE(size);
+
+        setBackend(Backend::Blas);
+        CHECK(string{getBackendName()} != "builtin");
+        gemm(2.0, block, right, 0.5, blas, true, false);
+        gemm(1.0, right, block, 1.0, blas, false, true);
+
+        setBackend(Backend::Builtin);
+        CHECK(string{getBackendName()} == "builtin");
+        gemm(2.0, block, right, 0.5, builtin, true, false);
+        gemm(1.0, right, block, 1.0, builtin, false, true);
+
+        CHECK(isEqual(blas, builtin));
+    }
+
+    // Determinant by LU factorization, also of singular matrix
+    setBackend(Backend::Blas);
+    const double blasDeterminant = !*globalMat1;
+    const double blasSingular = !SquareMat{4, Fill, 2.0};
+
+    setBackend(Backend::Builtin);
+    CHECK(isEqual(blasDeterminant, !*globalMat1));
+    CHECK(isEqual(blasSingular, 0));
+
+    setBackend(backend);
+}
+
+TEST_CASE("Float matrices")
+{
+    const double unit = ldexp(1.0, -24);
+
+    // Small, blocked with more than one depth panel, and with more than one rows chunk,
+    // that multiplied by threads
+    for (size_t size : {(size_t)DEFAULT_SIZE, GEMM_KC + 45, 4 * GEMM_MC + 45})
+    {
+        SquareMat left{size, Uninitialized};
+        SquareMat right{size, Uninitialized};
+
+        for (size_t i = 0; i < size; i++)
+            for (size_t j = 0; j < size; j++)
+            {
+                left[i][j] = sin(i * 0.37 + j);
+                right[i][j] = cos(i + j * 0.11) / 3;
+            }
+
+        const SquareMatF leftF{left};
+        const SquareMatF rightF{right};
+        const SquareMatF product = leftF * rightF;
+
+        // All-double products: of the float cells, of the original cells, and of their absolute values
+        const SquareMat exact = SquareMat{leftF} * SquareMat{rightF};
+        const SquareMat original = left * right;
+        SquareMat absLeft{left}, absRight{right};
+
+        for (size_t i = 0; i < size; i++)
+            for (size_t j = 0; j < size; j++)
+            {
+                absLeft[i][j] = abs(absLeft[i][j]);
+                absRight[i][j] = abs(absRight[i][j]);
+            }
+
+        const SquareMat bound = absLeft * absRight;
+        bool inExactBound = true, inOriginalBound = true;
+
+        for (size_t i = 0; i < size; i++)
+            for (size_t j = 0; j < size; j++)
+            {
+                // One rounding to float, above double summation error
+                inExactBound &= abs(product[i][j] - exact[i][j]) <=
+                    unit * abs(exact[i][j]) + size * ldexp(1.0, -53) * bound[i][j] * 1.01;
+
+                // And the operands rounding
+                inOriginalBound &= abs(product[i][j] - original[i][j]) <= 3 * unit * bound[i][j] * 1.01;
+            }
+
+        CAPTURE(size);
+        CHECK(inExactBound);
+        CHECK(inOriginalBound);
+
+        // Sum is accumulated in double, so only the cells rounding differs
+        const SquareMat leftFloats{leftF};
+        const double absSum = ConstSquareMatView{absLeft}.getSum();
+
+        CHECK(abs(leftF.getSum() - ConstSquareMatView{leftFloats}.getSum()) <= size * size * ldexp(1.0, -53) * absSum);
+        CHECK(abs(leftF.getSum() - ConstSquareMatView{left}.getSum()) <= 1.01 * unit * absSum);
+
+        // Any number of threads gives exactly the same cells
+        SquareMatF parallel{size};
+        multiply(leftF, rightF, parallel, 3);
+
+        CHECK(isIdentical(SquareMat{product}, SquareMat{parallel}));
+    }
+
+    SquareMatF mat{3, Identity};
+    mat *= 2.0;
+    mat += SquareMatF{3, Fill, 1.0f};
+
+    CHECK(mat[0][0] == 3.0f);
+    CHECK(mat[0][1] == 1.0f);
+    CHECK(mat.getSum() == 15);
+    CHECK(isEqual(SquareMat{mat * mat}, SquareMat{mat} * SquareMat{mat}));
+    CHECK(mat - mat == SquareMatF{3});
+    CHECK_THROWS(mat * SquareMatF{4});
+    CHECK_THROWS(multiply(mat, mat, mat));
+    CHECK_THROWS(SquareMatF{0});
+}
+
+/// @brief Calculate Fibonacci number modulo m by fast doubling, independently of the matrices
+/// @param n Index of the number
+/// @param m The modulus
+/// @return F(n) mod m
+int64_t fibonacci(uint64_t n, int64_t m)
+{
+    unsigned __int128 a = 0, b = 1;
+
+    for (int bit = 63; bit >= 0; bit--)
+    {
+        // F(2k) = F(k) * (2F(k+1) - F(k)), F(2k+1) = F(k)^2 + F(k+1)^2
+        const unsigned __int128 c = a * ((2 * b + m - a) % m) % m;
+        const unsigned __int128 d = (a * a + b * b) % m;
+
+        a = c;
+        b = d;
+
+        // F(2k+1), F(2k+2)
+        if ((n >> bit) & 1)
+        {
+            a = d;
+            b = (c + d) % m;
+        }
+    }
+
+    return (int64_t)a;
+}
+
+TEST_CASE("Modular matrices")
+{
+    const int64_t prime = 1000000007;
+
+    // Fibonacci matrix power is exact also for huge exponents, that doubles can't reach
+    SquareMatMod fib{2, prime};
+    fib.set(0, 0, 1);
+    fib.set(0, 1, 1);
+    fib.set(1, 0, 1);
+
+    for (uint64_t n : {(uint64_t)1, (uint64_t)90, (uint64_t)1000000000000000000ULL, (uint64_t)UINT64_MAX})
+    {
+        CAPTURE(n);
+        CHECK((fib ^ n)[0][1] == fibonacci(n, prime));
+    }
+
+    CHECK((fib ^ 0) == SquareMatMod{2, prime, Identity});
+
+    // Products agree with exact 128 bit sums, also for the biggest modulus that reduces after each 4 products
+    for (int64_t modulus : {(int64_t)7, prime, SquareMatMod::MAX_MODULUS})
+        for (size_t size : {(size_t)DEFAULT_SIZE, GEMM_KC + 45})
+        {
+            SquareMatMod left{size, modulus};
+            SquareMatMod right{size, modulus};
+
+            for (size_t i = 0; i < size; i++)
+                for (size_t j = 0; j < size; j++)
+                {
+                    left.set(i, j, modulus - 1 - (int64_t)((i * 7 + j * 3) % 11));
+                    right.set(i, j, -(int64_t)(i * 5 + j));
+                }
+
+            const SquareMatMod product = left * right;
+            bool exact = true;
+
+            for (size_t i = 0; i < size; i++)
+                for (size_t j = 0; j < size; j++)
+                {
+                    unsigned __int128 sum = 0;
+
+                    for (size_t k = 0; k < size; k++)
+                        sum += (unsigned __int128)left[i][k] * right[k][j];
+
+                    exact &= product[i][j] == (int64_t)(sum % modulus);
+                }
+
+            CAPTURE(modulus);
+            CAPTURE(size);
+            CHECK(exact);
+
+            // Any number of threads gives the same cells
+            SquareMatMod parallel{size, modulus};
+            multiply(left, right, parallel, 3);
+
+            CHECK(parallel == product);
+            CHECK((left ^ 3) == left * left * left);
+        }
+
+    // Small values agree with the double path and operator%
+    SquareMat ints{4};
+
+    for (size_t i = 0; i < 4; i++)
+        for (size_t j = 0; j < 4; j++)
+            ints[i][j] = (double)((i * 3 + j * 5) % 9);
+
+    SquareMatMod mod{ints, 5};
+
+    CHECK(isEqual(SquareMat{mod * mod}, (ints * ints) % 5));
+    CHECK(isEqual(SquareMat{mod ^ 5}, (ints ^ 5) % 5));
+
+    mod *= -3;
+    mod += SquareMatMod{4, 5, Identity};
+    mod -= SquareMatMod{4, 5, Identity} * 2;
+
+    bool reduced = true;
+
+    for (size_t i = 0; i < 4; i++)
+        for (size_t j = 0; j < 4; j++)
+            reduced &= mod[i][j] == ((llround(ints[i][j]) * -3 - (i == j)) % 5 + 5) % 5;
+
+    CHECK(reduced);
+
+    CHECK_THROWS(SquareMatMod{2, 0});
+    CHECK_THROWS(SquareMatMod{2, SquareMatMod::MAX_MODULUS + 1});
+    CHECK_THROWS(fib * SquareMatMod{2, 7});
+    CHECK_THROWS(fib * SquareMatMod{3, prime});
+    CHECK_THROWS(fib.set(2, 0, 1));
+    CHECK(SquareMatMod{2, 1, Identity} == SquareMatMod{2, 1});
+}
+
+TEST_CASE("LU determinant")
+{
+    // LU agrees with the exact cofactor expansion, also when the first pivot is zero
+    for (size_t size = 1; size <= 8; size++)
+    {
+        SquareMat mat{size, Uninitialized};
+        SquareMat other{size, Uninitialized};
+
+        fillOperands(mat, other);
+        mat[0][0] = 0;
+
+        const double exact = mat.determinant(DeterminantMethod::Cofactor);
+
+        CAPTURE(size);
+        // Integer cells have integer determinant, so LU rounding error is far under 0.5
+        CHECK(round(!mat) == exact);
+        CHECK(mat.determinant() == !mat);
+    }
+
+    CHECK(isEqual(!*globalMat1, globalMat1->determinant(DeterminantMethod::Cofactor)));
+    CHECK(isEqual(!globalMat1->block(1, 1, 2), (*globalMat1)[1][1] * (*globalMat1)[2][2] - (*globalMat1)[1][2] * (*globalMat1)[2][1]));
+
+    // Sizes that cofactor expansion never finishes: det(L * U) is the product of their diagonals,
+    // and rows swap (that the pivoting must follow) changes its sign
+    for (size_t size : {(size_t)20, (size_t)200})
+    {
+        SquareMat lower{size, Identity};
+        SquareMat upper{size, Uninitialized};
+        double expected = 1;
+
+        for (size_t i = 0; i < size; i++)
+            for (size_t j = 0; j < size; j++)
+            {
+                // Small cells out of the diagonals keep the product well conditioned
+                if (i > j)
+                    lower[i][j] = sin(i * 0.37 + j) / size;
+
+                upper[i][j] = i > j ? 0 : (i == j ? 1.0 + (i % 3) * 0.5 : cos(i + j * 0.11) / size);
+            }
+
+        for (size_t i = 0; i < size; i++)
+            expected *= upper[i][i];
+
+        SquareMat mat = lower * upper;
+
+        CAPTURE(size);
+        CHECK(abs(!mat - expected) <= 1e-9 * abs(expected));
+
+        swap_ranges(mat[0], mat[0] + size, mat[1]);
+        CHECK(abs(!mat + expected) <= 1e-9 * abs(expected));
+    }
+
+    // Singular matrix
+    SquareMat singular{*globalMat1};
+
+    for (size_t j = 0; j < DEFAULT_SIZE; j++)
+        singular[2][j] = singular[0][j] * 2 - singular[1][j];
+
+    CHECK(abs(!singular) < 1e-9);
+    CHECK(!SquareMat{5} == 0);
+}
+
+TEST_CASE("Batched multiplication")
+{
+    // Count that is not whole vectors, and more than one chunk
+    for (size_t size : {4, 6})
+    {
+        const size_t count = SquareMatBatch::CHUNK + 13;
+
+        SquareMatBatch left{size, count};
+        SquareMatBatch right{size, count};
+
+        CHECK(left.getSize() == size);
+        CHECK(left.getCount() == count);
+
+        // Fill left batch through the cell arrays, and right batch matrix by matrix
+        for (size_t i = 0; i < size; i++)
+            for (size_t j = 0; j < size; j++)
+                for (size_t m = 0; m < count; m++)
+                    left.cell(i, j)[m] = (double)((i * 7 + j * 3 + m) % 11) - 5;
+
+        for (size_t m = 0; m < count; m++)
+        {
+            SquareMat mat{size, Uninitialized};
+
+            for (size_t i = 0; i < size; i++)
+                for (size_t j = 0; j < size; j++)
+                    mat[i][j] = (double)((i * 5 + j + 2 * m) % 13) / 4;
+
+            right.set(m, mat);
+        }
+
+        SquareMatBatch product = left * right;
+        bool equal = true;
+
+        for (size_t m = 0; m < count; m++)
+            equal &= isEqual(product.get(m), left.get(m) * right.get(m));
+
+        CAPTURE(size);
+        CHECK(equal);
+        CHECK(product(count - 1, size - 1, size - 1) == product.get(count - 1)[size - 1][size - 1]);
+    }
+
+    SquareMatBatch batch{DEFAULT_SIZE, 2};
+    batch.set(1, *globalMat1);
+
+    CHECK(isEqual(batch.get(1), *globalMat1));
+    CHECK(isEqual(batch.get(0), *zeroMat));
+    CHECK_THROWS(batch.set(2, *globalMat1));
+    CHECK_THROWS(batch.set(0, SquareMat{4}));
+    CHECK_THROWS(batch * SquareMatBatch{DEFAULT_SIZE, 3});
+    CHECK_THROWS(multiply(batch, batch, batch));
+}
+
+TEST_CASE("Fixed size matrices")
+{
+    // Check that the operators are calculated in compile time
+    constexpr FixedSquareMat<2> rotation{{0, -1, 1, 0}};
+    static_assert(((rotation ^ 4) + rotation)[0][1] == -1);
+    static_assert((!(rotation * FixedSquareMat<2>{Identity})) == 1);
+    static_assert((~rotation)[0][1] == 1);
+
+    // Check the same results as SquareMat
+    FixedSquareMat<DEFAULT_SIZE> fixed1{*globalMat1};
+    FixedSquareMat<DEFAULT_SIZE> fixed2{*globalMat2};
+
+    CHECK(isEqual(fixed1 + fixed2, *globalMat1 + *globalMat2));
+    CHECK(isEqual(fixed1 - fixed2, *globalMat1 - *globalMat2));
+    CHECK(isEqual(fixed1 * fixed2, *globalMat1 * *globalMat2));
+    CHECK(isEqual(fixed1 % fixed2, *globalMat1 % *globalMat2));
+    CHECK(isEqual(2.5 * fixed1 / 2, 2.5 * *globalMat1 / 2));
+    CHECK(isEqual(fixed1 % 3, *globalMat1 % 3));
+    CHECK(isEqual(~fixed1, ~*globalMat1));
+    CHECK(isEqual(-fixed1, -*globalMat1));
+    CHECK(isEqual(fixed1 ^ 5, *globalMat1 ^ 5));
+    CHECK(isEqual(fixed1 ^ 0, *identityMat));
+    CHECK(isEqual(!fixed1, !*globalMat1));
+    CHECK((fixed1 == fixed2) == (*globalMat1 == *globalMat2));
+    CHECK((fixed1 < fixed2) == (*globalMat1 < *globalMat2));
+
+    FixedSquareMat<DEFAULT_SIZE> copy{fixed1};
+    CHECK(isEqual(copy++, fixed1));
+    CHECK(isEqual(--copy, fixed1));
+
+    // Check determinant of bigger size, by Gaussian elimination
+    SquareMat mat{6, Uninitialized};
+    SquareMat other{6, Uninitialized};
+
+    fillOperands(mat, other);
+    mat += SquareMat{6, Identity};
+
+    CHECK(isEqual(!FixedSquareMat<6>{mat}, !mat));
+    CHECK(isEqual(!(FixedSquareMat<4>{Fill, 2.0}), 0));
+    CHECK_THROWS(FixedSquareMat<4>{*globalMat1});
+    CHECK_THROWS(fixed1 / 0);
+}
+
+TEST_CASE("Contiguous storage")
+{
+    SquareMat mat{*globalMat1};
+
+    // Ensure all rows are in one block, each one stride after the previous one
+    for (size_t i = 1; i < DEFAULT_SIZE; i++)
+        CHECK(mat[i] - mat[i - 1] == (ptrdiff_t)mat.getStride());
+
+    CHECK(mat.getStride() >= DEFAULT_SIZE);
+
+    // Ensure re-allocation by assignment keeps the rows in one block
+    SquareMat bigMat{8};
+    bigMat = mat;
+
+    CHECK(bigMat[DEFAULT_SIZE - 1] - bigMat[0] == (ptrdiff_t)((DEFAULT_SIZE - 1) * bigMat.getStride()));
+    CHECK(isEqual(*globalMat1, bigMat));
+}
+
+TEST_CASE("Aligned and padded rows")
+{
+    // Check that every row starts on a cache line
+    for (size_t size : {1, 3, 8, 9, 64, 100})
+    {
+        SquareMat mat{size};
+
+        CHECK(mat.getAlignment() == SquareMat::ALIGNMENT);
+        CHECK(mat.getStride() >= size);
+
+        for (size_t i = 0; i < size; i++)
+            CHECK((uintptr_t)mat[i] % SquareMat::ALIGNMENT == 0);
+    }
+
+    // Check that power of 2 sizes are padded, so rows not conflict in the cache
+    for (size_t size : {64, 256, 512})
+    {
+        SquareMat mat{size};
+
+        CHECK(mat.getStride() > size);
+        CHECK((mat.getStride() * sizeof(double)) % 512 != 0);
+    }
+}
+
 TEST_CASE("Equality operators")
 {
     // Checking identical matrices
@@ -190,6 +1623,22 @@ TEST_SUITE("Unary operators")
         mat[0][1] = mat[1][1] = mat[2][1] = 0;
 
         CHECK_FALSE(!mat);
+
+        // Check determinent of bigger triangular matrix is the multiply of its diagonal
+        SquareMat triangle{7};
+        double diagonal = 1;
+
+        for (size_t i = 0; i < 7; i++)
+        {
+            triangle[i][i] = i + 1.5;
+            diagonal *= i + 1.5;
+
+            for (size_t j = i + 1; j < 7; j++)
+                triangle[i][j] = i * 2.0 - j;
+        }
+
+        CHECK(isEqual(diagonal, !triangle));
+        CHECK(isEqual(diagonal, !(~triangle)));
     }
 
     TEST_CASE("Minus")
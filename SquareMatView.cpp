@@ -0,0 +1,260 @@
+// liorbrown@outlook.co.il
+
+#include <stdexcept>
+#include <cmath>
+#include <algorithm>
+#include <utility>
+#include "SquareMatView.hpp"
+#include "SquareMat.hpp"
+#include "MatKernels.hpp"
+#include "MatBlas.hpp"
+
+namespace Matrix{
+
+    /// @brief Swap 2 columns of the view, along all its rows
+    /// @param view View to swap its columns
+    /// @param col1 First column index
+    /// @param col2 Seconed column index
+    static void swapColumns(const SquareMatView& view, size_t col1, size_t col2)
+    {
+        for (size_t i = 0; i < view.getSize(); i++)
+            std::swap(view[i][col1], view[i][col2]);
+    }
+
+    /// @brief Calculate determinant by cofactor expansion along first row.
+    /// Instead of copying each minor, the columns are rotated so the minor of cell (0,col)
+    /// is always the block that starts in cell (1,1), with its columns in their original order.
+    /// The columns order is restored before return
+    /// @param view View to calculate its determinant, its columns reordered during calculation
+    /// @return The determinant of the view
+    static double cofactorDeterminant(const SquareMatView& view)
+    {
+        const size_t size = view.getSize();
+
+        // This is recursion stop condition
+        if (size == 1)
+            return view[0][0];
+
+        const SquareMatView minor = view.block(1, 1, size - 1);
+        double result = 0;
+        double sign = 1;
+
+        // This determinant function calculate always with first row,
+        // So make one loop for each row's cells
+        for (size_t col = 0; col < size; col++)
+        {
+            // Bring column col to the front, then columns 1..col hold original columns 0..col-1,
+            // and columns after col are untouched
+            if (col)
+                swapColumns(view, 0, col);
+
+            // Calculate determinant by recursion call for this cell minor
+            result += sign * view[0][0] * cofactorDeterminant(minor);
+            sign = -sign;
+        }
+
+        // Undo the swaps in reverse order, to restore original columns order
+        for (size_t col = size - 1; col > 0; col--)
+            swapColumns(view, 0, col);
+
+        return result;
+    }
+
+    /// @brief Calculate determinant by LU factorization with partial pivoting, in place:
+    /// each column is eliminated below its pivot, so the view ends as U (of PA = LU),
+    /// and the determinant is the product of U diagonal, with sign for each rows swap
+    /// @param view View to calculate its determinant, its cells are overridden
+    /// @return The determinant of the view
+    static double luDeterminant(const SquareMatView& view)
+    {
+        const size_t size = view.getSize();
+        const Kernels& kernels = getKernels();
+        double result = 1;
+
+        for (size_t col = 0; col < size; col++)
+        {
+            // Take the biggest cell in the column as pivot, so the elimination is stable
+            size_t pivot = col;
+
+            for (size_t i = col + 1; i < size; i++)
+                if (abs(view[i][col]) > abs(view[pivot][col]))
+                    pivot = i;
+
+            // Zero column under the diagonal means the matrix is singular
+            if (!view[pivot][col])
+                return 0;
+
+            // Rows swap changes the determinant sign
+            if (pivot != col)
+            {
+                swap_ranges(view[pivot] + col, view[pivot] + size, view[col] + col);
+                result = -result;
+            }
+
+            const double* pivotRow = view[col];
+
+            result *= pivotRow[col];
+
+            // Subtract the pivot row from each row under it with the vectorized kernels,
+            // so its cell in this column becomes zero
+            for (size_t i = col + 1; i < size; i++)
+            {
+                double* row = view[i];
+
+                kernels.addScaled(row + col + 1, pivotRow + col + 1, -row[col] / pivotRow[col], size - col - 1);
+            }
+        }
+
+        return result;
+    }
+
+    ConstSquareMatView::ConstSquareMatView(const double* cells, size_t size, size_t stride) :
+        cells(cells), size(size), stride(stride)
+    {
+        if (!size)
+            throw invalid_argument("Matrix size must be positive 🫤");
+
+        if (stride < size)
+            throw invalid_argument("Rows stride can't be less than matrix size 🫤");
+    }
+
+    // Matrix operators take views of their operands for reading, so this view not detach
+    // shared matrix, and it has no way to change the cells
+    ConstSquareMatView::ConstSquareMatView(const SquareMat& mat) :
+        ConstSquareMatView(mat[0], mat.getSize(), mat.getStride()) {}
+
+    // Non const [] of the matrix detaches it, so changes through this view never reach
+    // other matrices that shared its memory
+    SquareMatView::SquareMatView(SquareMat& mat) :
+        SquareMatView(mat[0], mat.getSize(), mat.getStride()) {}
+
+    ConstSquareMatView ConstSquareMatView::block(size_t row, size_t col, size_t size) const
+    {
+        if (row + size > this->size || col + size > this->size)
+            throw invalid_argument("Block is out of matrix bounds 🫤");
+
+        return ConstSquareMatView{(*this)[row] + col, size, this->stride};
+    }
+
+    SquareMatView SquareMatView::block(size_t row, size_t col, size_t size) const
+    {
+        if (row + size > this->size || col + size > this->size)
+            throw invalid_argument("Block is out of matrix bounds 🫤");
+
+        return SquareMatView{(*this)[row] + col, size, this->stride};
+    }
+
+    double ConstSquareMatView::getSum() const
+    {
+        const Kernels& kernels = getKernels();
+        double result = 0;
+
+        // Runs on each row and summerize all its values
+        for (size_t i = 0; i < this->size; i++)
+            result += kernels.sum((*this)[i], this->size);
+
+        return result;
+    }
+
+    SquareMatView& SquareMatView::operator-=(const ConstSquareMatView& other)
+    {
+        if (this->size != other.getSize())
+            throw invalid_argument("Matrices not in the same size 🫤");
+
+        // Runs on each row with the vectorized kernels,
+        // and for each cell subtruct the value of corresponding cell in other block
+        const Kernels& kernels = getKernels();
+
+        for (size_t i = 0; i < this->size; i++)
+            kernels.subtract((*this)[i], other[i], this->size);
+
+        return (*this);
+    }
+
+    SquareMatView& SquareMatView::operator+=(const ConstSquareMatView& other)
+    {
+        if (this->size != other.getSize())
+            throw invalid_argument("Matrices not in the same size 🫤");
+
+        // Runs on each row with the vectorized kernels,
+        // and for each cell add the value of corresponding cell in other block
+        const Kernels& kernels = getKernels();
+
+        for (size_t i = 0; i < this->size; i++)
+            kernels.add((*this)[i], other[i], this->size);
+
+        return (*this);
+    }
+
+    SquareMatView& SquareMatView::operator%=(const ConstSquareMatView& other)
+    {
+        if (this->size != other.getSize())
+            throw invalid_argument("Matrices not in the same size 🫤");
+
+        // Runs on each row with the vectorized kernels,
+        // and for each cell multiply it with the value of corresponding cell in other block
+        const Kernels& kernels = getKernels();
+
+        for (size_t i = 0; i < this->size; i++)
+            kernels.multiply((*this)[i], other[i], this->size);
+
+        return (*this);
+    }
+
+    SquareMatView& SquareMatView::operator*=(const double scalar)
+    {
+        // Runs on each row with the vectorized kernels, and multiply its cells by scalar
+        const Kernels& kernels = getKernels();
+
+        for (size_t i = 0; i < this->size; i++)
+            kernels.scale((*this)[i], scalar, this->size);
+
+        return (*this);
+    }
+
+    SquareMatView& SquareMatView::operator/=(const double scalar)
+    {
+        if (!scalar)
+            throw invalid_argument("Can't divide by zero 🫤");
+
+        // Runs on each row with the vectorized kernels, and divide its cells by given scalar
+        const Kernels& kernels = getKernels();
+
+        for (size_t i = 0; i < this->size; i++)
+            kernels.divide((*this)[i], scalar, this->size);
+
+        return (*this);
+    }
+
+    SquareMatView& SquareMatView::operator%=(const int scalar)
+    {
+        if (!scalar)
+            throw invalid_argument("Can't divide by zero 🫤");
+
+        // Runs on each cell, and modulo it by given scalar
+        for (size_t i = 0; i < this->size; i++)
+        {
+            double* row = (*this)[i];
+
+            for (size_t j = 0; j < this->size; j++)
+                row[j] = fmod(row[j], scalar);
+        }
+
+        return (*this);
+    }
+
+    double ConstSquareMatView::determinant(DeterminantMethod method) const
+    {
+        double result;
+
+        // Builds with BLAS library calculate LU factorization by it
+        if (method == DeterminantMethod::LU && blasDeterminant(*this, result))
+            return result;
+
+        // Both methods change the cells, so work on one copy of the block,
+        // that small blocks keep inline
+        SquareMat work{*this};
+
+        return method == DeterminantMethod::Cofactor ? cofactorDeterminant(work) : luDeterminant(work);
+    }
+}
@@ -0,0 +1,156 @@
+// liorbrown@outlook.co.il
+
+#pragma once
+
+#include <cstddef>
+
+using namespace std;
+
+namespace Matrix{
+
+    class SquareMat;
+
+    /// @brief How determinant is calculated
+    enum class DeterminantMethod{
+        /// @brief LU factorization with partial pivoting, O(n^3) in one copy of the matrix
+        LU,
+
+        /// @brief Cofactor expansion along the first row, O(n!) so only for small matrices.
+        /// It only multiplies and adds cells, so for integer cells it is exact
+        /// (as long as the products stay under 2^53)
+        Cofactor
+    };
+
+    /// @brief This class represents a square block of matrix cells for reading, without owning them.
+    /// The view only holds pointer to its first cell, its size and the row stride,
+    /// so it is cheap to create and copy. Matrix operators take their operands by it,
+    /// so reading shared matrix never detaches it.
+    /// The view is valid only as long as the viewed matrix memory is alive
+    class ConstSquareMatView{
+        protected:
+
+            /// @brief Pointer to the first cell of the block
+            const double* cells;
+
+            size_t size;
+
+            /// @brief Distance (in doubles) between the starts of two consecutive rows
+            size_t stride;
+
+        public:
+
+            /// @brief Ctor - creates view on given cells
+            /// @param cells Pointer to the first cell
+            /// @param size The size of the block
+            /// @param stride Distance (in doubles) between the starts of two consecutive rows
+            ConstSquareMatView(const double* cells, size_t size, size_t stride);
+
+            /// @brief Ctor - creates view on the whole matrix, without detaching it
+            /// @param mat Matrix to view
+            ConstSquareMatView(const SquareMat& mat);
+
+            size_t getSize() const {return this->size;}
+
+            /// @brief Get the distance (in doubles) between the starts of two consecutive rows
+            /// @return The view row stride
+            size_t getStride() const {return this->stride;}
+
+            /// @brief Return view row for reading, given row index
+            /// @param row Index of wanted row
+            /// @return Pointer to the wanted row
+            const double* operator[](size_t row) const {return this->cells + row * this->stride;}
+
+            /// @brief Get view on square block of this view
+            /// @param row Row index of block first cell
+            /// @param col Column index of block first cell
+            /// @param size The size of the block
+            /// @return View on the block
+            ConstSquareMatView block(size_t row, size_t col, size_t size) const;
+
+            /// @brief Get sum of all view numbers
+            /// @return The sum of all numbers in the view
+            double getSum() const;
+
+            /// @brief Calculate the determinant of this block
+            /// @param method How to calculate it
+            /// @return The determinant of this block
+            double determinant(DeterminantMethod method = DeterminantMethod::LU) const;
+
+            /// @brief Return the determinant of this block, by LU factorization
+            /// @return The determinant of this block
+            double operator!() const {return this->determinant();}
+    };
+
+    /// @brief This class represents a square block of matrix cells, that can be changed through it.
+    /// Changes through the view change the viewed matrix, so view on SquareMat can be taken
+    /// only from non const matrix, that gets its own memory first if it is shared
+    class SquareMatView : public ConstSquareMatView{
+        public:
+
+            /// @brief Ctor - creates view on given cells
+            /// @param cells Pointer to the first cell
+            /// @param size The size of the block
+            /// @param stride Distance (in doubles) between the starts of two consecutive rows
+            SquareMatView(double* cells, size_t size, size_t stride) : ConstSquareMatView(cells, size, stride) {}
+
+            /// @brief Ctor - creates view on the whole matrix, shared matrix is detached first
+            /// @param mat Matrix to view
+            SquareMatView(SquareMat& mat);
+
+            /// @brief Return view row, given row index
+            /// @param row Index of wanted row
+            /// @return Pointer to the wanted row
+            double* operator[](size_t row) const {return const_cast<double*>(this->cells) + row * this->stride;}
+
+            /// @brief Get view on square block of this view
+            /// @param row Row index of block first cell
+            /// @param col Column index of block first cell
+            /// @param size The size of the block
+            /// @return View on the block
+            SquareMatView block(size_t row, size_t col, size_t size) const;
+
+            // ---------------- Self assignment operators ----------------------
+            // All of them change the viewed cells, and work like their SquareMat equivalents
+
+            /// @brief Substruct other block from this block, cell by cell
+            /// @param other Other block to subtruct from this block
+            /// @return This view
+            SquareMatView& operator-=(const ConstSquareMatView& other);
+
+            /// @brief Summerize other block with this block, cell by cell
+            /// @param other Other block to Summerize to this block
+            /// @return This view
+            SquareMatView& operator+=(const ConstSquareMatView& other);
+
+            /// @brief Multiply this block by other block, cell by cell
+            /// @param other Other block to multiply to this block
+            /// @return This view
+            SquareMatView& operator%=(const ConstSquareMatView& other);
+
+            /// @brief Multipy each cell of this block by scalar
+            /// @param scalar The scalar to multliply by
+            /// @return This view
+            SquareMatView& operator*=(const double scalar);
+
+            /// @brief Divide each cell of this block by scalar
+            /// @param scalar The scalar to divide by
+            /// @return This view
+            SquareMatView& operator/=(const double scalar);
+
+            /// @brief Modulo each cell of this block by scalar
+            /// @param scalar The scalar to modulo by
+            /// @return This view
+            SquareMatView& operator%=(const int scalar);
+    };
+
+    /// @brief Block that matrix multiplication reads as its transpose, while packing it,
+    /// so the transpose is never copied. Created by transposed(), like in a * transposed(b)
+    struct TransposedView{
+        ConstSquareMatView view;
+    };
+
+    /// @brief Mark block to be multiplied as its transpose
+    /// @param view The block, it must stay alive until the multiplication is done
+    /// @return The block, marked as transposed
+    inline TransposedView transposed(const ConstSquareMatView& view) {return TransposedView{view};}
+}